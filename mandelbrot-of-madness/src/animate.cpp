@@ -0,0 +1,142 @@
+#include <iostream>
+#include <cstdio>
+#include <memory>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "core/command-line.hpp"
+#include "core/animation.hpp"
+#include "core/multithreaded-backend.hpp"
+#include "core/gpu-backend.hpp"
+#include "core/perturbation-backend.hpp"
+
+// Output path of one frame. Paths with a printf-style field like frames/%05d.png are formatted with the frame
+// number, otherwise the number is put in front of the extension
+static std::string FramePath(const std::string &pattern, int frame) {
+    char buffer[1024];
+
+    if (pattern.find('%') != std::string::npos) {
+        snprintf(buffer, sizeof(buffer), pattern.c_str(), frame);
+        return buffer;
+    }
+
+    size_t dot = pattern.find_last_of('.');
+    std::string stem = dot == std::string::npos ? pattern : pattern.substr(0, dot);
+    std::string extension = dot == std::string::npos ? ".png" : pattern.substr(dot);
+
+    snprintf(buffer, sizeof(buffer), "%s-%06d%s", stem.c_str(), frame, extension.c_str());
+    return buffer;
+}
+
+int main(int argc, char **argv) {
+    std::string keyframesPath;
+    std::string backendName = "multithreaded";
+
+    // Animation flags are taken out here, everything else goes to the shared parser
+    std::vector<char *> args = {argv[0]};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--keyframes" && i + 1 < argc) {
+            keyframesPath = argv[++i];
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backendName = argv[++i];
+        } else {
+            args.push_back(argv[i]);
+        }
+
+        if (arg == "--help" || arg == "-h") {
+            std::cerr << "Animation: --keyframes FILE with \"frame resolution real imag [iterations]\" lines,\n";
+            std::cerr << "--backend multithreaded|gpu|deep, and --output - for raw RGB on stdout or a frame path like frames/%05d.png\n\n";
+        }
+    }
+
+    CommandLine commandLine;
+    if (!ParseCommandLine(args.size(), args.data(), commandLine)) return -1;
+
+    if (keyframesPath.empty() || commandLine.jobs.size() != 1) {
+        std::cerr << "An error occured when trying to start the animation, --keyframes and --output are required!\n";
+        return -1;
+    }
+
+    std::vector<Keyframe> keyframes;
+    if (!ReadKeyframes(keyframesPath, keyframes)) return -1;
+
+    std::unique_ptr<RenderBackend> backend;
+
+    if (backendName == "multithreaded") backend.reset(new MultiThreadedBackend(commandLine.threading));
+    else if (backendName == "gpu") backend.reset(new GpuBackend(commandLine.gpu));
+    else if (backendName == "deep") backend.reset(new PerturbationBackend(commandLine.threading));
+    else {
+        std::cerr << "An error occured when trying to pick backend " << backendName << "!\n";
+        return -1;
+    }
+
+    const RenderJob &job = commandLine.jobs[0];
+    bool pipe = job.filepath == "-";
+
+#if defined(_WIN32)
+    if (pipe) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    AnimationRenderer renderer(*backend);
+    std::vector<uint8_t> row((size_t) job.request.width * 3);
+
+    int first = keyframes.front().frame;
+    int last = keyframes.back().frame;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (int frame = first; frame <= last; frame++) {
+        RenderRequest request = InterpolateFrame(job.request, keyframes, frame);
+        const uint8_t *pixels;
+
+        if (!renderer.RenderFrame(request, pixels)) {
+            std::cerr << "An error occured when trying to render frame " << frame << "!\n";
+            return -1;
+        }
+
+        if (pipe) {
+            // Packed RGB24, the layout ffmpeg reads with -f rawvideo -pix_fmt rgb24
+            for (int y = 0; y < request.height; y++) {
+                const uint8_t *in = pixels + (size_t) y * request.width * 4;
+
+                for (int x = 0; x < request.width; x++) {
+                    row[x * 3 + 0] = in[x * 4 + 0];
+                    row[x * 3 + 1] = in[x * 4 + 1];
+                    row[x * 3 + 2] = in[x * 4 + 2];
+                }
+
+                if (fwrite(row.data(), 1, row.size(), stdout) != row.size()) {
+                    std::cerr << "An error occured when trying to write frame " << frame << " to stdout!\n";
+                    return -1;
+                }
+            }
+        } else {
+            sf::Image image(sf::Vector2u(request.width, request.height), pixels);
+
+            if (!image.saveToFile(FramePath(job.filepath, frame))) {
+                std::cerr << "An error occured when trying to save frame " << frame << "!\n";
+                return -1;
+            }
+        }
+
+        std::cerr << "\rFrame " << frame << " / " << last << std::flush;
+    }
+
+    fflush(stdout);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    int frames = last - first + 1;
+
+    std::cerr << "\nRendered " << frames << " frames in " << std::chrono::duration<double>(end - start).count() << "s, ";
+    std::cerr << renderer.GetReusedFrames() << " reused the previous frame, ";
+    std::cerr << 100.0 * renderer.GetRenderedPixels() / renderer.GetTotalPixels() << "% of pixels computed\n";
+
+    return 0;
+}
@@ -1,336 +1,267 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
 #include <iostream>
-#include <complex>
+#include <sstream>
 #include <string>
 #include <thread>
-#include <numeric>
-#include <chrono>
+#include <vector>
 
 #include <SFML/Graphics/Image.hpp>
 
-#define CL_TARGET_OPENCL_VERSION 220
-#include <CL/cl.h>
+#include "core/singlethreaded-backend.hpp"
+#include "core/multithreaded-backend.hpp"
+#include "core/gpu-backend.hpp"
 
-void singlethreaded(int width, int height, double resolution, int iterations) {
-    std::complex<double> pivot;
+// Monotonic, high_resolution_clock may follow the wall clock
+using Clock = std::chrono::steady_clock;
 
-    double *plane = new double[width * height];
+struct BenchmarkOptions {
+    // Untimed runs before the timed ones, so caches, page faults and the pool's first wake-up are paid outside them
+    int warmup = 2;
+    int repetitions = 10;
 
-    for (int y = 0; y < height; y++) {
-        double imag = pivot.imag() + ((y - (float) height / 2.0f) / resolution);
+    // Threads of the multithreaded backend are resolved to a number up front, so every result says how many ran
+    MultiThreadedOptions threading;
+    GpuOptions gpu;
 
-        for (int x = 0; x < width; x++) {
-            double real = pivot.real() + ((x - (float) width / 2.0f) / resolution);
+    // Also runs the sweep over frame sizes, resolutions and limits
+    bool sweep = true;
 
-            std::complex<double> c = std::complex<double>(real, imag);
-            std::complex<double> z;
-            int i = 0;
-            for (; i < iterations && std::norm(z) < 2; i++) {
-                z = z * z + c;
-            }
+    std::string csvPath;
+    std::string jsonPath;
+};
 
-            plane[y * width + x] = (double) i / (double) iterations;
-        }
-    }
+// Milliseconds over the timed repetitions of one configuration
+struct Statistics {
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+    double mean = 0;
+    double stddev = 0;
+};
 
-    sf::Image image = sf::Image(sf::Vector2u(width, height), sf::Color(0, 0, 0));
+struct BenchmarkResult {
+    std::string suite;
+    std::string backend;
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            unsigned char color = 255.0f - plane[y * width + x] * 255.0f;
-            image.setPixel(sf::Vector2u(x, y), sf::Color(color, color, color));
-        }
-    }
+    // What was varied within the suite, such as "bulb check" or "per pixel"
+    std::string variant;
 
-    delete[] plane;
-}
+    // CPU threads the backend rendered with, 0 for the GPU
+    int threads;
 
-void CalculateMandelbrot(double *plane, int width, int height, double resolution, int iterations, std::complex<double> pivot, int from, int to) {
-    for (int i = from; i < to; i++) {
-        int y = i / width;
-        int x = i % width;
+    RenderRequest request;
+    Statistics statistics;
+};
 
-        double imag = pivot.imag() + ((y - (float) height / 2.0f) / resolution);
-        double real = pivot.real() + ((x - (float) width / 2.0f) / resolution);
+static BenchmarkOptions options;
+static std::vector<BenchmarkResult> results;
 
-        std::complex<double> c = std::complex<double>(real, imag);
-        std::complex<double> z;
-        
-        int iter = 0;
-        for (; iter < iterations && std::norm(z) < 2; iter++) {
-            z = z * z + c;
-        }
+static Statistics GetStatistics(std::vector<double> times) {
+    Statistics statistics;
+    size_t count = times.size();
 
-        plane[y * width + x] = (double) iter / (double) iterations;
-    }
-}
+    std::sort(times.begin(), times.end());
 
-void multithreaded(int width, int height, double resolution, int iterations) {
-    std::complex<double> pivot;
+    statistics.min = times.front();
+    statistics.median = count % 2 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
 
-    double *plane = new double[width * height];
+    // Nearest rank, so the p95 of few repetitions is the slowest one rather than a guess between two
+    statistics.p95 = times[(size_t) std::ceil(0.95 * count) - 1];
 
-    int threadcount = std::thread::hardware_concurrency();
+    double sum = 0;
+    for (double time : times) sum += time;
+    statistics.mean = sum / count;
 
-    int pointsPerChunk = std::lcm(sizeof(double), 256) / sizeof(double);
-    int chunks = width * height / pointsPerChunk;
+    // Sample deviation, the repetitions are a sample of the runs the machine could do
+    double squares = 0;
+    for (double time : times) squares += (time - statistics.mean) * (time - statistics.mean);
+    statistics.stddev = count > 1 ? std::sqrt(squares / (count - 1)) : 0;
 
-    if (chunks == 0) {
-        for (int y = 0; y < height; y++) {
-            double imag = pivot.imag() + ((y - (float) height / 2.0f) / resolution);
-    
-            for (int x = 0; x < width; x++) {
-                double real = pivot.real() + ((x - (float) width / 2.0f) / resolution);
-    
-                std::complex<double> c = std::complex<double>(real, imag);
-                std::complex<double> z;
-                int i = 0;
-                for (; i < iterations && std::norm(z) < 2; i++) {
-                    z = z * z + c;
-                }
-    
-                plane[y * width + x] = (double) i / (double) iterations;
-            }
-        }
-    } else {
-        int chunksPerThread = chunks / threadcount;
-        int residualChunks = chunks % threadcount;
+    return statistics;
+}
 
-        std::thread *threads = new std::thread[threadcount];
+// Runs run the warm-up and repetition counts of options, timing only the repetitions, and records the result. Returns
+// false without recording anything as soon as run fails, when the backend can't do what the suite asks
+static bool Measure(const std::string &suite, const RenderBackend &backend, const std::string &variant, const RenderRequest &request,
+                    const std::function<bool()> &run, Statistics &statistics) {
+    for (int i = 0; i < options.warmup; i++) {
+        if (!run()) return false;
+    }
 
-        int i = 256 - ((int) plane % 256);
-        i += sizeof(double) - ((i - (int) plane) % sizeof(double));
-        i += chunksPerThread;
+    std::vector<double> times;
 
-        if (residualChunks > 0) {
-            i += pointsPerChunk;
-            residualChunks--;
-        }
+    for (int i = 0; i < options.repetitions; i++) {
+        auto start = Clock::now();
+        bool success = run();
+        auto end = Clock::now();
 
-        threads[0] = std::thread(CalculateMandelbrot, plane, width, height, resolution, iterations, pivot, 0, i);
+        if (!success) return false;
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
 
-        for (int t = 1; t < threadcount - 1; t++) {
-            int j = i + chunksPerThread * pointsPerChunk;
+    statistics = GetStatistics(times);
+    results.push_back({suite, backend.GetName(), variant, backend.GetThreadCount(), request, statistics});
 
-            if (residualChunks > 0) {
-                j += pointsPerChunk;
-                residualChunks--;
-            }
+    return true;
+}
 
-            threads[t] = std::thread(CalculateMandelbrot, plane, width, height, resolution, iterations, pivot, i, j);
+static void PrintStatistics(const Statistics &statistics) {
+    std::cout << statistics.median << "ms (min " << statistics.min << ", p95 " << statistics.p95 << ", stddev " << statistics.stddev << ")";
+}
 
-            i = j;
-        }
+// Times the default GUI view at 800 iterations with and without the cardioid/bulb rejection test
+void BenchmarkBulbCheck(RenderBackend **backends, int backendCount, sf::Image &image) {
+    RenderRequest request;
+    request.width = 800;
+    request.height = 600;
+    request.resolution = 256;
+    request.iterations = 800;
 
-        threads[threadcount - 1] = std::thread(CalculateMandelbrot, plane, width, height, resolution, iterations, pivot, i, width * height);
+    std::cout << "Cardioid/Bulb Check, Dimension: 800x600 Resolution: 256 Iterations: 800\n";
 
-        for (int t = 0; t < threadcount; t++) {
-            threads[t].join();
-        }
+    const char *variants[] = {"without bulb check", "with bulb check"};
 
-        delete[] threads;
-    }
+    for (int i = 0; i < backendCount; i++) {
+        Statistics statistics[2];
+        bool measured = true;
 
-    sf::Image image = sf::Image(sf::Vector2u(width, height), sf::Color(0, 0, 0));
+        for (int check = 0; check < 2 && measured; check++) {
+            request.bulbCheck = check;
+            measured = Measure("bulb-check", *backends[i], variants[check], request, [&]() { return backends[i]->Render(request, image); }, statistics[check]);
+        }
 
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            unsigned char color = 255.0f - plane[y * width + x] * 255.0f;
-            image.setPixel(sf::Vector2u(x, y), sf::Color(color, color, color));
+        std::cout << "- " << backends[i]->GetName() << " : ";
+
+        if (!measured) {
+            std::cout << "failed\n";
+            continue;
         }
+
+        PrintStatistics(statistics[0]);
+        std::cout << " without, ";
+        PrintStatistics(statistics[1]);
+        std::cout << " with (" << statistics[0].median / statistics[1].median << "x)\n";
     }
 
-    delete[] plane;
+    std::cout << "\n";
 }
 
-const char mandelbrotKernelSource[] = R"(
-__kernel void generate_mandelbrot(int2 dimensions, float resolution, int iterations, float2 pivot, __global uchar4 *out) {
-    int x = get_global_id(0);
-    int y = get_global_id(1);
-
-    if (x >= dimensions.x || y >= dimensions.y) return;
-
-    float2 z = pivot + ((float2)(x, y) - (float2)(dimensions.x, dimensions.y) / 2) / resolution;
-    float2 c = z;
+// Times Mariani-Silver subdivision against the per-pixel reference and counts the pixels where they disagree
+void BenchmarkRenderModes(RenderBackend **backends, int backendCount) {
+    RenderRequest request;
+    request.width = 1920;
+    request.height = 1080;
+    request.resolution = 400;
+    request.iterations = 800;
 
-    int iter = 0;
-    for (int i = 0; i < iterations; i++) {
-        float xx = z.x * z.x;
-        float yy = z.y * z.y;
+    std::cout << "Subdivide vs Per Pixel, Dimension: 1920x1080 Resolution: 400 Iterations: 800\n";
 
-        if (xx + yy > 4.0f) break;
+    for (int i = 0; i < backendCount; i++) {
+        sf::Image images[2];
+        Statistics statistics[2];
+        bool measured = true;
 
-        z = (float2)(xx - yy, 2 * z.x * z.y) + c;
+        RenderMode modes[] = {RenderMode::PerPixel, RenderMode::Subdivide};
+        const char *variants[] = {"per pixel", "subdivide"};
 
-        iter = i;
-    }
-    
-    float lerp = 1.0f - (float)(iter) / (float)(iterations);
-    float3 color = (float3)(255.0f, 255.0f, 255.0f) * lerp;
-    
-    out[y * dimensions.x + x] = (uchar4)(color.x, color.y, color.z, 255);
-}
-)";
-
-void gpuaccel(int width, int height, double resolution, int iterations) {
-    const char *source = mandelbrotKernelSource;
-    size_t sourceLength = sizeof(mandelbrotKernelSource);
-    int dimensions[2] = {width, height};
-    size_t szDimensions[2] = {width, height};
-    float pivot[2] = {0, 0};
-
-    cl_int clError;
-    cl_uint platformCount;
-    cl_platform_id *platforms;
-    cl_device_id device;
-    cl_context context;
-    cl_command_queue commandQueue;
-    cl_program program;
-    cl_kernel kernel;
-    cl_mem buffer;
-
-    clError = clGetPlatformIDs(0, nullptr, &platformCount);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to count platforms!\n";
-        return;
-    }
+        for (int m = 0; m < 2 && measured; m++) {
+            request.mode = modes[m];
+            measured = Measure("render-mode", *backends[i], variants[m], request, [&]() { return backends[i]->Render(request, images[m]); }, statistics[m]);
+        }
 
-    platforms = new cl_platform_id[platformCount];
-    clError = clGetPlatformIDs(platformCount, platforms, &platformCount);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to query platforms!\n";
-        delete[] platforms;
-        return;
-    }
-    
-    for (int i = 0; i < platformCount; i++) {
-        clError = clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_DEFAULT, 1, &device, nullptr);
-        if (clError == CL_SUCCESS) break;
-    }
+        std::cout << "- " << backends[i]->GetName() << " : ";
 
-    if (device == NULL) {
-        std::cout << "An error occured when trying to obtain OpenCL device!\n";
-        delete[] platforms;
-        return;
-    }
+        if (!measured) {
+            std::cout << "failed\n";
+            continue;
+        }
 
-    context = clCreateContext(0, 1, &device, nullptr, nullptr, &clError);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to create context!\n";
-        delete[] platforms;
-        return;
-    }
+        const uint8_t *reference = images[0].getPixelsPtr();
+        const uint8_t *subdivided = images[1].getPixelsPtr();
 
-    commandQueue = clCreateCommandQueue(context, device, 0, &clError);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to create command queue!\n";
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+        int mismatches = 0;
+        for (int p = 0; p < request.width * request.height; p++) {
+            if (reference[p * 4] != subdivided[p * 4]) mismatches++;
+        }
 
-    program = clCreateProgramWithSource(context, 1, &source, &sourceLength, &clError);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to create program!\n";
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
+        PrintStatistics(statistics[0]);
+        std::cout << " per pixel, ";
+        PrintStatistics(statistics[1]);
+        std::cout << " subdivided (" << statistics[0].median / statistics[1].median << "x), " << mismatches << " pixels differ\n";
     }
 
-    clError = clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to build program!\n";
+    std::cout << "\n";
+}
 
-        size_t len;
-        char buffer[2048];
+// Times the passes that run after iterating on a 1920x1080 smooth frame: recolouring the kept field, equalizing it,
+// and a render with 8 samples on every edge pixel against one without
+void BenchmarkColouring(RenderBackend **backends, int backendCount, sf::Image &image) {
+    RenderRequest request;
+    request.width = 1920;
+    request.height = 1080;
+    request.resolution = 400;
+    request.iterations = 800;
+    request.smooth = true;
+    request.palette = PaletteType::Fire;
+
+    RenderRequest equalized = request;
+    equalized.equalize = true;
+
+    RenderRequest antialiased = request;
+    antialiased.antialias = 8;
+
+    std::cout << "Colouring, Dimension: 1920x1080 Resolution: 400 Iterations: 800 Smooth\n";
+
+    struct Variant {
+        const char *name;
+        const RenderRequest *request;
+        bool recolor;
+    };
 
-        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+    // The anti-aliased render is last, it replaces the field the recolours use
+    Variant variants[] = {
+        {"render", &request, false},
+        {"recolor", &request, true},
+        {"equalize", &equalized, true},
+        {"antialias 8", &antialiased, false}
+    };
 
-        std::cout << buffer << "\n";
+    for (int i = 0; i < backendCount; i++) {
+        std::cout << "- " << backends[i]->GetName() << " :";
 
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+        // Recolouring needs a field of the same frame, the render before it leaves one
+        if (!backends[i]->Render(request, image)) {
+            std::cout << " failed\n";
+            continue;
+        }
 
-    kernel = clCreateKernel(program, "generate_mandelbrot", &clError);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to create kernel!\n";
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+        for (const Variant &variant : variants) {
+            RenderBackend *backend = backends[i];
+            const RenderRequest &run = *variant.request;
+            Statistics statistics;
 
-    buffer = clCreateBuffer(context, CL_MEM_READ_WRITE, width * height * sizeof(cl_uchar4), nullptr, &clError);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to create buffer!\n";
-        clReleaseKernel(kernel);
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+            bool measured = Measure("colouring", *backend, variant.name, run, [&]() {
+                return variant.recolor ? backend->Recolor(run, image) : backend->Render(run, image);
+            }, statistics);
 
-    clError = clSetKernelArg(kernel, 0, sizeof(cl_int2), dimensions);
-    clError |= clSetKernelArg(kernel, 1, sizeof(cl_float), &resolution);
-    clError |= clSetKernelArg(kernel, 2, sizeof(cl_int), &iterations);
-    clError |= clSetKernelArg(kernel, 3, sizeof(cl_float2), pivot);
-    clError |= clSetKernelArg(kernel, 4, sizeof(cl_mem), &buffer);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to set kernel arguments!\n";
-        clReleaseMemObject(buffer);
-        clReleaseKernel(kernel);
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+            std::cout << (&variant == variants ? " " : ", ") << variant.name << " ";
 
-    clError = clEnqueueNDRangeKernel(commandQueue, kernel, 2, nullptr, szDimensions, nullptr, 0, nullptr, nullptr);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to enqueue work!\n";
-        clReleaseMemObject(buffer);
-        clReleaseKernel(kernel);
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
-    }
+            if (measured) PrintStatistics(statistics);
+            else std::cout << "unsupported";
+        }
 
-    uint8_t *pixelData = new uint8_t[width * height * 4];
-
-    clError = clEnqueueReadBuffer(commandQueue, buffer, CL_TRUE, 0, sizeof(uint8_t) * width * height * 4, pixelData, 0, nullptr, nullptr);
-    if (clError != CL_SUCCESS) {
-        std::cout << "An error occured when trying to enqueue read!\n";
-        delete[] pixelData;
-        clReleaseMemObject(buffer);
-        clReleaseKernel(kernel);
-        clReleaseProgram(program);
-        clReleaseCommandQueue(commandQueue);
-        clReleaseContext(context);
-        delete[] platforms;
-        return;
+        std::cout << "\n";
     }
 
-    delete[] pixelData;
-    clReleaseMemObject(buffer);
-    clReleaseKernel(kernel);
-    clReleaseProgram(program);
-    clReleaseCommandQueue(commandQueue);
-    clReleaseContext(context);
-    delete[] platforms;
+    std::cout << "\n";
 }
 
-using Clock = std::chrono::high_resolution_clock;
-
-int main(int argc, char **argv) {
+// Frame sizes, resolutions and limits of the sweep, one median per backend
+void BenchmarkSweep(RenderBackend **backends, int backendCount, sf::Image &image) {
     std::pair<int, int> dimensions[] = {
         {640, 360},
         {1280, 720},
@@ -351,24 +282,195 @@ int main(int argc, char **argv) {
                 std::cout << "Resolution: " << resolution << " ";
                 std::cout << "Iterations: " << iteration << "\n";
 
-                auto start = Clock::now();
-                singlethreaded(width, height, resolution, iteration);
-                auto end = Clock::now();
+                RenderRequest request;
+                request.width = width;
+                request.height = height;
+                request.resolution = resolution;
+                request.iterations = iteration;
 
-                std::cout << "- Singlethreaded : " << std::chrono::duration<double, std::milli>(end - start).count() << "ms\n";
+                for (int i = 0; i < backendCount; i++) {
+                    Statistics statistics;
 
-                start = Clock::now();
-                multithreaded(width, height, resolution, iteration);
-                end = Clock::now();
+                    std::cout << "- " << backends[i]->GetName() << " : ";
 
-                std::cout << "- Multithreaded : " << std::chrono::duration<double, std::milli>(end - start).count() << "ms\n";
-
-                start = Clock::now();
-                gpuaccel(width, height, resolution, iteration);
-                end = Clock::now();
+                    if (Measure("sweep", *backends[i], "", request, [&]() { return backends[i]->Render(request, image); }, statistics)) {
+                        PrintStatistics(statistics);
+                        std::cout << "\n";
+                    } else {
+                        std::cout << "failed\n";
+                    }
+                }
 
-                std::cout << "- GPU Accelerated : " << std::chrono::duration<double, std::milli>(end - start).count() << "ms\n\n";
+                std::cout << "\n";
             }
         }
     }
-}
\ No newline at end of file
+}
+
+static bool WriteCsv(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "An error occured when trying to open " << path << "!\n";
+        return false;
+    }
+
+    file << "suite,backend,variant,width,height,resolution,iterations,threads,warmup,repetitions,min_ms,median_ms,p95_ms,mean_ms,stddev_ms\n";
+
+    for (const BenchmarkResult &result : results) {
+        const RenderRequest &request = result.request;
+        const Statistics &statistics = result.statistics;
+
+        file << result.suite << "," << result.backend << "," << result.variant << ",";
+        file << request.width << "," << request.height << "," << request.resolution << "," << request.iterations << ",";
+        file << result.threads << "," << options.warmup << "," << options.repetitions << ",";
+        file << statistics.min << "," << statistics.median << "," << statistics.p95 << "," << statistics.mean << "," << statistics.stddev << "\n";
+    }
+
+    return true;
+}
+
+// None of the strings written hold quotes or backslashes, they come from backend names and the suites above
+static bool WriteJson(const std::string &path) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "An error occured when trying to open " << path << "!\n";
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"pinned\": " << (options.threading.pinThreads ? "true" : "false") << ",\n";
+    file << "  \"warmup\": " << options.warmup << ",\n";
+    file << "  \"repetitions\": " << options.repetitions << ",\n";
+    file << "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const RenderRequest &request = results[i].request;
+        const Statistics &statistics = results[i].statistics;
+
+        file << (i ? ",\n" : "\n");
+        file << "    {\"suite\": \"" << results[i].suite << "\", \"backend\": \"" << results[i].backend << "\", \"variant\": \"" << results[i].variant << "\", ";
+        file << "\"threads\": " << results[i].threads << ", \"width\": " << request.width << ", \"height\": " << request.height << ", \"resolution\": " << request.resolution << ", \"iterations\": " << request.iterations << ", ";
+        file << "\"min_ms\": " << statistics.min << ", \"median_ms\": " << statistics.median << ", \"p95_ms\": " << statistics.p95 << ", ";
+        file << "\"mean_ms\": " << statistics.mean << ", \"stddev_ms\": " << statistics.stddev << "}";
+    }
+
+    file << "\n  ]\n}\n";
+
+    return true;
+}
+
+static void PrintUsage(const char *program) {
+    std::cout << "Usage: " << program << " [flags]\n\n";
+    std::cout << "  --warmup N                 Untimed runs before every timed configuration, 2 by default\n";
+    std::cout << "  --repetitions N            Timed runs of every configuration, 10 by default\n";
+    std::cout << "  --threads N                Worker threads, 0 uses every hardware thread\n";
+    std::cout << "  --pin                      Bind each worker to one core\n";
+    std::cout << "  --device default|gpu|cpu   OpenCL device type\n";
+    std::cout << "  --no-sweep                 Skips the sweep over frame sizes, resolutions and limits\n";
+    std::cout << "  --csv FILE                 Writes one row per configuration and backend\n";
+    std::cout << "  --json FILE                Writes the same results as JSON\n";
+}
+
+static bool ParseInt(const std::string &text, int &value) {
+    std::istringstream stream(text);
+    return (stream >> value) && stream.eof();
+}
+
+static bool ParseOptions(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool valid = true;
+
+        if (flag == "--warmup" && value) {
+            valid = ParseInt(value, options.warmup) && options.warmup >= 0;
+            i++;
+        } else if (flag == "--repetitions" && value) {
+            valid = ParseInt(value, options.repetitions) && options.repetitions > 0;
+            i++;
+        } else if (flag == "--threads" && value) {
+            valid = ParseInt(value, options.threading.threadcount) && options.threading.threadcount >= 0;
+            i++;
+        } else if (flag == "--pin") {
+            options.threading.pinThreads = true;
+        } else if (flag == "--device" && value) {
+            std::string device = value;
+
+            if (device == "default") options.gpu.deviceType = GpuDeviceType::Default;
+            else if (device == "gpu") options.gpu.deviceType = GpuDeviceType::Gpu;
+            else if (device == "cpu") options.gpu.deviceType = GpuDeviceType::Cpu;
+            else valid = false;
+            i++;
+        } else if (flag == "--no-sweep") {
+            options.sweep = false;
+        } else if (flag == "--csv" && value) {
+            options.csvPath = value;
+            i++;
+        } else if (flag == "--json" && value) {
+            options.jsonPath = value;
+            i++;
+        } else {
+            std::cout << "An error occured when trying to parse " << flag << ", unknown flag or missing value!\n";
+            PrintUsage(argv[0]);
+            return false;
+        }
+
+        if (!valid) {
+            std::cout << "An error occured when trying to parse the value of " << flag << "!\n";
+            return false;
+        }
+    }
+
+    // The same count the pool would pick, written into the results instead of 0
+    if (options.threading.threadcount == 0) options.threading.threadcount = std::max(1u, std::thread::hardware_concurrency());
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!ParseOptions(argc, argv)) return -1;
+
+    SingleThreadedBackend singlethreaded;
+    MultiThreadedBackend multithreaded(options.threading);
+    GpuBackend gpuaccel(options.gpu);
+
+    RenderBackend *backends[] = {&singlethreaded, &multithreaded, &gpuaccel};
+
+    sf::Image image;
+
+    std::cout << "Threads: " << options.threading.threadcount << (options.threading.pinThreads ? " (pinned)" : "") << " ";
+    std::cout << "Warm-up: " << options.warmup << " Repetitions: " << options.repetitions << "\n\n";
+
+    // The first GPU render creates the OpenCL context and builds the program, or loads it from the binary cache
+    RenderRequest warmup;
+    warmup.width = 64;
+    warmup.height = 64;
+    warmup.iterations = 100;
+
+    auto start = Clock::now();
+    bool gpuReady = gpuaccel.Render(warmup, image);
+    auto end = Clock::now();
+
+    if (gpuReady) {
+        std::cout << "OpenCL setup: " << std::chrono::duration<double, std::milli>(end - start).count() << "ms";
+        std::cout << (gpuaccel.IsProgramCached() ? " (cached program)\n\n" : " (built from source)\n\n");
+    } else {
+        std::cout << "OpenCL setup failed, the GPU backend is left out\n\n";
+    }
+
+    int backendCount = gpuReady ? 3 : 2;
+
+    BenchmarkBulbCheck(backends, backendCount, image);
+
+    // The OpenCL kernel is per pixel only
+    BenchmarkRenderModes(backends, 2);
+
+    BenchmarkColouring(backends, backendCount, image);
+
+    if (options.sweep) BenchmarkSweep(backends, backendCount, image);
+
+    if (!options.csvPath.empty() && !WriteCsv(options.csvPath)) return -1;
+    if (!options.jsonPath.empty() && !WriteJson(options.jsonPath)) return -1;
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "core/animation.hpp"
+#include "core/bigfloat.hpp"
+#include "core/region-request.hpp"
+
+bool ReadKeyframes(const std::string &filepath, std::vector<Keyframe> &keyframes) {
+    std::ifstream file(filepath);
+    if (!file) {
+        std::cerr << "An error occured when trying to open " << filepath << "!\n";
+        return false;
+    }
+
+    std::string line;
+    int number = 0;
+
+    while (std::getline(file, line)) {
+        number++;
+
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream stream(line);
+        Keyframe keyframe;
+
+        if (!(stream >> keyframe.frame)) continue;
+
+        if (!(stream >> keyframe.resolution >> keyframe.pivotReal >> keyframe.pivotImag) || keyframe.resolution <= 0) {
+            std::cerr << "An error occured when trying to read " << filepath << " line " << number << ", expected frame resolution real imag [iterations]!\n";
+            return false;
+        }
+
+        stream >> keyframe.iterations;
+
+        if (!keyframes.empty() && keyframe.frame <= keyframes.back().frame) {
+            std::cerr << "An error occured when trying to read " << filepath << " line " << number << ", keyframes must be in frame order!\n";
+            return false;
+        }
+
+        keyframes.push_back(keyframe);
+    }
+
+    if (keyframes.empty()) {
+        std::cerr << "An error occured when trying to read " << filepath << ", no keyframes!\n";
+        return false;
+    }
+
+    return true;
+}
+
+RenderRequest InterpolateFrame(const RenderRequest &base, const std::vector<Keyframe> &keyframes, int frame) {
+    size_t next = 1;
+    while (next < keyframes.size() - 1 && keyframes[next].frame < frame) next++;
+
+    const Keyframe &a = keyframes[std::min(next - 1, keyframes.size() - 1)];
+    const Keyframe &b = keyframes[std::min(next, keyframes.size() - 1)];
+
+    double t = b.frame == a.frame ? 0 : std::clamp((double) (frame - a.frame) / (b.frame - a.frame), 0.0, 1.0);
+
+    RenderRequest request = base;
+
+    // Equal resolutions are copied rather than interpolated, so pans keep exactly one scale and can reuse pixels
+    double weight = t;
+
+    if (a.resolution == b.resolution) {
+        request.resolution = a.resolution;
+    } else {
+        request.resolution = a.resolution * std::pow(b.resolution / a.resolution, t);
+        weight = (1 / a.resolution - 1 / request.resolution) / (1 / a.resolution - 1 / b.resolution);
+    }
+
+    if (a.iterations > 0 && b.iterations > 0) {
+        request.iterations = std::lround(a.iterations + (b.iterations - a.iterations) * t);
+    }
+
+    int limbs = BigFloat::LimbsForResolution(std::max(a.resolution, b.resolution) * std::max(base.width, base.height));
+    BigFloat w = BigFloat::FromDouble(weight, limbs);
+
+    BigFloat aReal = BigFloat::FromString(a.pivotReal, limbs);
+    BigFloat aImag = BigFloat::FromString(a.pivotImag, limbs);
+    BigFloat real = aReal + (BigFloat::FromString(b.pivotReal, limbs) - aReal) * w;
+    BigFloat imag = aImag + (BigFloat::FromString(b.pivotImag, limbs) - aImag) * w;
+
+    request.pivot = std::complex<double>(real.ToDouble(), imag.ToDouble());
+    request.deepPivotReal = real.ToString();
+    request.deepPivotImag = imag.ToString();
+
+    return request;
+}
+
+// Everything but the pivot matches, so pixels of one frame are valid in the other after a shift
+static bool HasSameScale(const RenderRequest &a, const RenderRequest &b) {
+    return a.width == b.width && a.height == b.height && a.resolution == b.resolution && a.iterations == b.iterations &&
+        HasSameFractal(a, b) && a.mode == b.mode && a.bulbCheck == b.bulbCheck && a.periodTolerance == b.periodTolerance;
+}
+
+// Pixel offset between two pivots at the same resolution
+static double PixelDelta(double from, double to, const std::string &deepFrom, const std::string &deepTo, const RenderRequest &request) {
+    if (deepFrom.empty() || deepTo.empty()) return (to - from) * request.resolution;
+
+    int limbs = BigFloat::LimbsForResolution(request.resolution * std::max(request.width, request.height));
+    return (BigFloat::FromString(deepTo, limbs) - BigFloat::FromString(deepFrom, limbs)).ToDouble() * request.resolution;
+}
+
+bool AnimationRenderer::RenderRegion(const RenderRequest &request, int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) return true;
+
+    if (!backend.Render(RegionRequest(request, x, y, width, height), image)) return false;
+
+    const uint8_t *source = image.getPixelsPtr();
+
+    for (int row = 0; row < height; row++) {
+        std::memcpy(&frame[((size_t) (y + row) * request.width + x) * 4], source + (size_t) row * width * 4, (size_t) width * 4);
+    }
+
+    renderedPixels += (long long) width * height;
+    return true;
+}
+
+bool AnimationRenderer::RenderFrame(const RenderRequest &request, const uint8_t *&pixels) {
+    int width = request.width;
+    int height = request.height;
+
+    totalPixels += (long long) width * height;
+
+    // Equalized frames are shaded by the histogram of the whole frame, so pixels of the previous one carry its levels
+    // and strips rendered alone would each be equalized on their own. They are always rendered in full
+    if (hasPrevious && !request.equalize && HasSameScale(previous, request)) {
+        long long dx = std::llround(PixelDelta(previous.pivot.real(), request.pivot.real(), previous.deepPivotReal, request.deepPivotReal, request));
+        long long dy = std::llround(PixelDelta(previous.pivot.imag(), request.pivot.imag(), previous.deepPivotImag, request.deepPivotImag, request));
+
+        if (std::llabs(dx) < width && std::llabs(dy) < height) {
+            // Snapped onto the previous pixel grid, off the interpolated pivot by less than half a pixel
+            RenderRequest snapped = RegionRequest(previous, dx, dy, width, height);
+
+            shifted.assign(frame.size(), 0);
+
+            int copyWidth = width - std::llabs(dx);
+            int sourceX = std::max<long long>(dx, 0);
+            int targetX = std::max<long long>(-dx, 0);
+
+            for (int y = 0; y < height; y++) {
+                long long sourceY = y + dy;
+                if (sourceY < 0 || sourceY >= height) continue;
+
+                std::memcpy(&shifted[((size_t) y * width + targetX) * 4], &frame[((size_t) sourceY * width + sourceX) * 4], (size_t) copyWidth * 4);
+            }
+
+            frame.swap(shifted);
+
+            // Rows that scrolled in, then the column strip beside the rows that were kept
+            int keptFrom = std::max<long long>(-dy, 0);
+            int keptTo = height - std::max<long long>(dy, 0);
+
+            if (!RenderRegion(snapped, 0, 0, width, keptFrom)) return false;
+            if (!RenderRegion(snapped, 0, keptTo, width, height - keptTo)) return false;
+            if (!RenderRegion(snapped, dx > 0 ? copyWidth : 0, keptFrom, width - copyWidth, keptTo - keptFrom)) return false;
+
+            previous = snapped;
+            reusedFrames++;
+
+            pixels = frame.data();
+            return true;
+        }
+    }
+
+    if (!backend.Render(request, image)) return false;
+
+    frame.assign(image.getPixelsPtr(), image.getPixelsPtr() + (size_t) width * height * 4);
+    renderedPixels += (long long) width * height;
+
+    previous = request;
+    hasPrevious = true;
+
+    pixels = frame.data();
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/render.hpp"
+
+struct Keyframe {
+    int frame = 0;
+    double resolution = 1;
+
+    // Decimal pivot, so keyframes can sit past double precision
+    std::string pivotReal;
+    std::string pivotImag;
+
+    // 0 keeps the iteration count of the base request
+    int iterations = 0;
+};
+
+// Reads "frame resolution real imag [iterations]" lines, # starts a comment. Keyframes must be in frame order
+bool ReadKeyframes(const std::string &filepath, std::vector<Keyframe> &keyframes);
+
+// base with the pivot, resolution and iterations of frame. Resolution is interpolated geometrically so zooms
+// run at a constant rate, and the pivot moves in step with the view size so pans keep a constant on-screen speed
+RenderRequest InterpolateFrame(const RenderRequest &base, const std::vector<Keyframe> &keyframes, int frame);
+
+// Renders a sequence of frames through one backend. When a frame has the same scale as the one before it, its
+// pivot is snapped to the previous pixel grid, the overlap is shifted over and only the exposed strips are rendered.
+// Equalized frames never reuse pixels
+class AnimationRenderer {
+public:
+    explicit AnimationRenderer(RenderBackend &backend) : backend(backend) {}
+
+    // On success pixels points to width * height RGBA8 pixels, valid until the next call
+    bool RenderFrame(const RenderRequest &request, const uint8_t *&pixels);
+
+    int GetReusedFrames() const { return reusedFrames; }
+
+    // Pixels the backend actually rendered, against the total of every frame
+    long long GetRenderedPixels() const { return renderedPixels; }
+    long long GetTotalPixels() const { return totalPixels; }
+
+private:
+    bool RenderRegion(const RenderRequest &request, int x, int y, int width, int height);
+
+    RenderBackend &backend;
+
+    RenderRequest previous;
+    bool hasPrevious = false;
+
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> shifted;
+    sf::Image image;
+
+    int reusedFrames = 0;
+    long long renderedPixels = 0;
+    long long totalPixels = 0;
+};
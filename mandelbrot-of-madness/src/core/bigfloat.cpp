@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+
+#include "core/bigfloat.hpp"
+
+BigFloat::BigFloat(int fractionLimbs) : fractionLimbs(std::max(1, fractionLimbs)), limbs(this->fractionLimbs + 1, 0) {
+
+}
+
+BigFloat BigFloat::FromDouble(double value, int fractionLimbs) {
+    BigFloat result(fractionLimbs);
+
+    if (value == 0 || !std::isfinite(value)) return result;
+
+    result.negative = value < 0;
+    value = std::fabs(value);
+
+    // value = mantissa * 2^exponent with a 53-bit integer mantissa
+    int exponent;
+    double fraction = std::frexp(value, &exponent);
+    uint64_t mantissa = (uint64_t) std::ldexp(fraction, 53);
+    exponent -= 53;
+
+    // Bit 0 of limbs[0] has weight 2^(-32 * fractionLimbs)
+    int shift = exponent + 32 * result.fractionLimbs;
+
+    for (int bit = 0; bit < 53; bit++) {
+        if (!(mantissa & ((uint64_t) 1 << bit))) continue;
+
+        int position = bit + shift;
+        if (position < 0 || position >= 32 * (int) result.limbs.size()) continue;
+
+        result.limbs[position / 32] |= (uint32_t) 1 << (position % 32);
+    }
+
+    return result;
+}
+
+BigFloat BigFloat::FromString(const std::string &text, int fractionLimbs) {
+    BigFloat result(fractionLimbs);
+
+    size_t i = 0;
+    while (i < text.size() && std::isspace((unsigned char) text[i])) i++;
+
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    std::string digits;
+    int pointPosition = -1;
+
+    for (; i < text.size(); i++) {
+        char ch = text[i];
+
+        if (std::isdigit((unsigned char) ch)) {
+            digits += ch;
+        } else if (ch == '.' && pointPosition < 0) {
+            pointPosition = digits.size();
+        } else {
+            break;
+        }
+    }
+
+    if (pointPosition < 0) pointPosition = digits.size();
+
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        pointPosition += std::atoi(text.c_str() + i + 1);
+    }
+
+    // Split the digits at the (shifted) decimal point
+    std::string integerDigits;
+    std::string fractionDigits;
+
+    if (pointPosition <= 0) {
+        fractionDigits = std::string(-pointPosition, '0') + digits;
+    } else if (pointPosition >= (int) digits.size()) {
+        integerDigits = digits + std::string(pointPosition - digits.size(), '0');
+    } else {
+        integerDigits = digits.substr(0, pointPosition);
+        fractionDigits = digits.substr(pointPosition);
+    }
+
+    uint32_t integer = 0;
+    for (char ch : integerDigits) {
+        integer = integer * 10 + (ch - '0');
+    }
+
+    // Horner's scheme from the last digit: fraction = (digit + fraction) / 10
+    std::vector<uint32_t> &limbs = result.limbs;
+    int n = result.fractionLimbs;
+
+    // More decimal digits than the fraction has bits can't change the result
+    if ((int) fractionDigits.size() > 10 * n + 10) {
+        fractionDigits.resize(10 * n + 10);
+    }
+
+    for (auto it = fractionDigits.rbegin(); it != fractionDigits.rend(); it++) {
+        limbs[n] = *it - '0';
+
+        uint64_t remainder = 0;
+        for (int l = n; l >= 0; l--) {
+            uint64_t current = (remainder << 32) | limbs[l];
+            limbs[l] = current / 10;
+            remainder = current % 10;
+        }
+    }
+
+    limbs[n] = integer;
+    result.negative = negative && !result.IsZero();
+    return result;
+}
+
+int BigFloat::LimbsForResolution(double resolution) {
+    double bits = std::log2(std::max(1.0, resolution)) + 64;
+    return (int) std::ceil(bits / 32);
+}
+
+void BigFloat::SetFractionLimbs(int limbs) {
+    limbs = std::max(1, limbs);
+
+    if (limbs > fractionLimbs) {
+        this->limbs.insert(this->limbs.begin(), limbs - fractionLimbs, 0);
+    } else if (limbs < fractionLimbs) {
+        this->limbs.erase(this->limbs.begin(), this->limbs.begin() + (fractionLimbs - limbs));
+    }
+
+    fractionLimbs = limbs;
+    if (IsZero()) negative = false;
+}
+
+double BigFloat::ToDouble() const {
+    double value = 0;
+
+    for (int l = limbs.size() - 1; l >= 0; l--) {
+        value += std::ldexp((double) limbs[l], 32 * (l - fractionLimbs));
+    }
+
+    return negative ? -value : value;
+}
+
+std::string BigFloat::ToString() const {
+    std::string text = negative ? "-" : "";
+    text += std::to_string(limbs[fractionLimbs]);
+    text += '.';
+
+    std::vector<uint32_t> fraction(limbs.begin(), limbs.begin() + fractionLimbs);
+
+    // Every fraction bit adds log10(2) decimal digits
+    int digits = (int) std::ceil(32 * fractionLimbs * 0.30103) + 1;
+
+    for (int d = 0; d < digits; d++) {
+        uint64_t carry = 0;
+
+        for (int l = 0; l < fractionLimbs; l++) {
+            uint64_t current = (uint64_t) fraction[l] * 10 + carry;
+            fraction[l] = (uint32_t) current;
+            carry = current >> 32;
+        }
+
+        text += (char) ('0' + carry);
+    }
+
+    return text;
+}
+
+bool BigFloat::IsZero() const {
+    return std::all_of(limbs.begin(), limbs.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+int BigFloat::CompareMagnitudes(const BigFloat &a, const BigFloat &b) {
+    for (int l = a.limbs.size() - 1; l >= 0; l--) {
+        if (a.limbs[l] != b.limbs[l]) return a.limbs[l] < b.limbs[l] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+BigFloat BigFloat::AddMagnitudes(const BigFloat &a, const BigFloat &b, bool negative) {
+    BigFloat result(a.fractionLimbs);
+
+    uint64_t carry = 0;
+    for (size_t l = 0; l < a.limbs.size(); l++) {
+        uint64_t sum = (uint64_t) a.limbs[l] + b.limbs[l] + carry;
+        result.limbs[l] = (uint32_t) sum;
+        carry = sum >> 32;
+    }
+
+    result.negative = negative && !result.IsZero();
+    return result;
+}
+
+BigFloat BigFloat::SubtractMagnitudes(const BigFloat &a, const BigFloat &b, bool negative) {
+    BigFloat result(a.fractionLimbs);
+
+    int64_t borrow = 0;
+    for (size_t l = 0; l < a.limbs.size(); l++) {
+        int64_t difference = (int64_t) a.limbs[l] - b.limbs[l] - borrow;
+        borrow = difference < 0;
+        result.limbs[l] = (uint32_t) (difference + (borrow << 32));
+    }
+
+    result.negative = negative && !result.IsZero();
+    return result;
+}
+
+BigFloat BigFloat::operator+(const BigFloat &other) const {
+    int limbs = std::max(fractionLimbs, other.fractionLimbs);
+
+    BigFloat a = *this;
+    BigFloat b = other;
+    a.SetFractionLimbs(limbs);
+    b.SetFractionLimbs(limbs);
+
+    if (a.negative == b.negative) return AddMagnitudes(a, b, a.negative);
+
+    if (CompareMagnitudes(a, b) >= 0) return SubtractMagnitudes(a, b, a.negative);
+    return SubtractMagnitudes(b, a, b.negative);
+}
+
+BigFloat BigFloat::operator-(const BigFloat &other) const {
+    return *this + (-other);
+}
+
+BigFloat BigFloat::operator-() const {
+    BigFloat result = *this;
+    result.negative = !negative && !IsZero();
+    return result;
+}
+
+BigFloat BigFloat::operator*(const BigFloat &other) const {
+    int n = std::max(fractionLimbs, other.fractionLimbs);
+
+    BigFloat a = *this;
+    BigFloat b = other;
+    a.SetFractionLimbs(n);
+    b.SetFractionLimbs(n);
+
+    // Schoolbook product, then drop the extra fraction limbs. Bits above the integer limb are lost
+    size_t size = a.limbs.size();
+    std::vector<uint64_t> product(2 * size + 1, 0);
+
+    for (size_t i = 0; i < size; i++) {
+        if (a.limbs[i] == 0) continue;
+
+        uint64_t carry = 0;
+        for (size_t j = 0; j < size; j++) {
+            uint64_t current = (uint64_t) a.limbs[i] * b.limbs[j] + product[i + j] + carry;
+            product[i + j] = (uint32_t) current;
+            carry = current >> 32;
+        }
+
+        product[i + size] += carry;
+    }
+
+    BigFloat result(n);
+    for (size_t l = 0; l < size; l++) {
+        result.limbs[l] = (uint32_t) product[l + n];
+    }
+
+    result.negative = (a.negative != b.negative) && !result.IsZero();
+    return result;
+}
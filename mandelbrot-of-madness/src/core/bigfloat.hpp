@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Signed fixed-point number with one 32-bit integer limb and a configurable number of 32-bit fraction limbs.
+// Only what the perturbation reference orbit and deep pivots need: |value| < 2^32, add, subtract, multiply
+class BigFloat {
+public:
+    explicit BigFloat(int fractionLimbs = 2);
+
+    static BigFloat FromDouble(double value, int fractionLimbs);
+
+    // Accepts plain or scientific decimal notation, e.g. "-0.743643887037158704752191506114774" or "1.5e-20"
+    static BigFloat FromString(const std::string &text, int fractionLimbs);
+
+    // Fraction limbs needed to address single pixels at the given resolution, with guard bits to spare
+    static int LimbsForResolution(double resolution);
+
+    int GetFractionLimbs() const { return fractionLimbs; }
+
+    // Extends with zeros or truncates the fraction to the given number of limbs
+    void SetFractionLimbs(int limbs);
+
+    double ToDouble() const;
+
+    // Decimal representation with enough digits to round-trip the fraction
+    std::string ToString() const;
+
+    BigFloat operator+(const BigFloat &other) const;
+    BigFloat operator-(const BigFloat &other) const;
+    BigFloat operator*(const BigFloat &other) const;
+    BigFloat operator-() const;
+
+    BigFloat &operator+=(const BigFloat &other) { return *this = *this + other; }
+    BigFloat &operator-=(const BigFloat &other) { return *this = *this - other; }
+
+private:
+    bool IsZero() const;
+
+    // Adds or subtracts magnitudes, both operands already at the same precision
+    static BigFloat AddMagnitudes(const BigFloat &a, const BigFloat &b, bool negative);
+    static BigFloat SubtractMagnitudes(const BigFloat &a, const BigFloat &b, bool negative);
+    static int CompareMagnitudes(const BigFloat &a, const BigFloat &b);
+
+    int fractionLimbs;
+    bool negative = false;
+
+    // Little endian, limbs[fractionLimbs] is the integer part
+    std::vector<uint32_t> limbs;
+};
@@ -0,0 +1,351 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <memory>
+
+#include "core/command-line.hpp"
+#include "core/prompt.hpp"
+#include "core/continuation.hpp"
+#include "core/tiled-backend.hpp"
+#include "core/palette.hpp"
+
+void PrintUsage(const char *program) {
+    std::cout << "Usage: " << program << " [options]\n";
+    std::cout << "Without --output or --batch the frame is asked for on stdin.\n\n";
+    std::cout << "Frame:\n";
+    std::cout << "  --width N, --height N      Image size in pixels\n";
+    std::cout << "  --resolution R             Pixels per unit of the complex plane\n";
+    std::cout << "  --iterations N             Iteration limit\n";
+    std::cout << "  --pivot RE IM              Center of the image, any number of decimal digits\n";
+    std::cout << "  --fractal NAME             mandelbrot, julia, multibrot or burning-ship\n";
+    std::cout << "  --julia RE IM              Julia set of c = RE + IM i, implies --fractal julia\n";
+    std::cout << "  --power N                  Exponent of the multibrot, 3 by default\n";
+    std::cout << "  --mode per-pixel|subdivide Render mode of the CPU backends\n";
+    std::cout << "  --no-bulb-check            Iterate points inside the cardioid and period-2 bulb\n";
+    std::cout << "  --period-tolerance T       Cycle detection tolerance in pixels, 0 disables it\n";
+    std::cout << "  --smooth                   Colours by the normalized iteration count, without bands\n";
+    std::cout << "  --palette NAME             greyscale, fire, ocean or rainbow\n";
+    std::cout << "  --palette-cycle N          Repeats the palette every N iterations instead of once\n";
+    std::cout << "  --equalize                 Spreads the palette over the histogram of the escape counts\n";
+    std::cout << "  --antialias N              Extra samples of every pixel on an edge, 0 disables it\n";
+    std::cout << "  --antialias-threshold N    Count difference to a neighbour that makes a pixel an edge\n";
+    std::cout << "  --output PATH              Output image, .png, .tif or .tiff streams large frames\n\n";
+    std::cout << "Batch:\n";
+    std::cout << "  --batch FILE               One job per line, written with the frame flags above.\n";
+    std::cout << "                             Frame flags on the command line are defaults for every line\n\n";
+    std::cout << "Backend:\n";
+    std::cout << "  --threads N                Worker threads, 0 uses every hardware thread\n";
+    std::cout << "  --pin                      Bind each worker to one core\n";
+    std::cout << "  --numa                     Place buffers on the NUMA node of the worker that renders them\n";
+    std::cout << "  --device default|gpu|cpu   OpenCL device type\n";
+    std::cout << "  --kernel-cache DIR         Directory for compiled OpenCL programs, empty disables it\n";
+    std::cout << "  --resume FILE              Keeps the per-pixel state of the view in FILE, so rendering it again\n";
+    std::cout << "                             with more iterations only continues the pixels that hadn't escaped\n";
+    std::cout << "  --tile-cache DIR           Builds frames at power of two resolutions from 128px tiles kept in DIR,\n";
+    std::cout << "                             rendering only the tiles no earlier frame needed\n";
+}
+
+static bool ParseInt(const std::string &text, int &value) {
+    std::istringstream stream(text);
+    return (stream >> value) && stream.eof();
+}
+
+static bool ParseDouble(const std::string &text, double &value) {
+    std::istringstream stream(text);
+    return (stream >> value) && stream.eof();
+}
+
+// Applies the frame flags in args to job. Backend flags are only accepted when commandLine is given
+static bool ParseArguments(const std::vector<std::string> &args, RenderJob &job, CommandLine *commandLine, std::string &batchPath) {
+    RenderRequest &request = job.request;
+
+    for (size_t i = 0; i < args.size(); i++) {
+        const std::string &flag = args[i];
+
+        // Flags with values take them from the following arguments
+        auto value = [&](int offset = 1) -> const std::string * {
+            return i + offset < args.size() ? &args[i + offset] : nullptr;
+        };
+
+        bool valid = true;
+        bool processFlag = false;
+
+        if (flag == "--width" && value()) {
+            valid = ParseInt(*value(), request.width) && request.width > 0;
+            i++;
+        } else if (flag == "--height" && value()) {
+            valid = ParseInt(*value(), request.height) && request.height > 0;
+            i++;
+        } else if (flag == "--resolution" && value()) {
+            valid = ParseDouble(*value(), request.resolution) && request.resolution > 0;
+            i++;
+        } else if (flag == "--iterations" && value()) {
+            valid = ParseInt(*value(), request.iterations) && request.iterations > 0;
+            i++;
+        } else if (flag == "--pivot" && value(2)) {
+            double real, imag;
+            valid = ParseDouble(*value(1), real) && ParseDouble(*value(2), imag);
+
+            request.pivot = std::complex<double>(real, imag);
+            request.deepPivotReal = *value(1);
+            request.deepPivotImag = *value(2);
+            i += 2;
+        } else if (flag == "--fractal" && value()) {
+            if (*value() == "mandelbrot") request.fractal = FractalType::Mandelbrot;
+            else if (*value() == "julia") request.fractal = FractalType::Julia;
+            else if (*value() == "multibrot") request.fractal = FractalType::Multibrot;
+            else if (*value() == "burning-ship") request.fractal = FractalType::BurningShip;
+            else valid = false;
+            i++;
+        } else if (flag == "--julia" && value(2)) {
+            double real, imag;
+            valid = ParseDouble(*value(1), real) && ParseDouble(*value(2), imag);
+
+            request.fractal = FractalType::Julia;
+            request.juliaSeed = std::complex<double>(real, imag);
+            i += 2;
+        } else if (flag == "--power" && value()) {
+            valid = ParseInt(*value(), request.power) && request.power >= 2;
+            i++;
+        } else if (flag == "--mode" && value()) {
+            if (*value() == "per-pixel") request.mode = RenderMode::PerPixel;
+            else if (*value() == "subdivide") request.mode = RenderMode::Subdivide;
+            else valid = false;
+            i++;
+        } else if (flag == "--no-bulb-check") {
+            request.bulbCheck = false;
+        } else if (flag == "--period-tolerance" && value()) {
+            valid = ParseDouble(*value(), request.periodTolerance) && request.periodTolerance >= 0;
+            i++;
+        } else if (flag == "--smooth") {
+            request.smooth = true;
+        } else if (flag == "--equalize") {
+            request.equalize = true;
+        } else if (flag == "--antialias" && value()) {
+            valid = ParseInt(*value(), request.antialias) && request.antialias >= 0;
+            i++;
+        } else if (flag == "--antialias-threshold" && value()) {
+            valid = ParseInt(*value(), request.antialiasThreshold) && request.antialiasThreshold >= 0;
+            i++;
+        } else if (flag == "--palette" && value()) {
+            valid = ParsePalette(*value(), request.palette);
+            i++;
+        } else if (flag == "--palette-cycle" && value()) {
+            valid = ParseDouble(*value(), request.paletteCycle) && request.paletteCycle >= 0;
+            i++;
+        } else if (flag == "--output" && value()) {
+            job.filepath = *value();
+            i++;
+        } else if (flag == "--batch" && value()) {
+            processFlag = true;
+            batchPath = *value();
+            i++;
+        } else if (flag == "--threads" && value()) {
+            processFlag = true;
+            valid = commandLine && ParseInt(*value(), commandLine->threading.threadcount) && commandLine->threading.threadcount >= 0;
+            i++;
+        } else if (flag == "--pin") {
+            processFlag = true;
+            if (commandLine) commandLine->threading.pinThreads = true;
+        } else if (flag == "--numa") {
+            processFlag = true;
+            if (commandLine) commandLine->threading.numaFirstTouch = true;
+        } else if (flag == "--device" && value()) {
+            processFlag = true;
+
+            if (commandLine) {
+                if (*value() == "default") commandLine->gpu.deviceType = GpuDeviceType::Default;
+                else if (*value() == "gpu") commandLine->gpu.deviceType = GpuDeviceType::Gpu;
+                else if (*value() == "cpu") commandLine->gpu.deviceType = GpuDeviceType::Cpu;
+                else valid = false;
+            }
+            i++;
+        } else if (flag == "--resume" && value()) {
+            processFlag = true;
+
+            if (commandLine) {
+                commandLine->resumePath = *value();
+                commandLine->threading.keepContinuation = true;
+            }
+            i++;
+        } else if (flag == "--tile-cache" && value()) {
+            processFlag = true;
+            if (commandLine) commandLine->tileCachePath = *value();
+            i++;
+        } else if (flag == "--kernel-cache" && value()) {
+            processFlag = true;
+            if (commandLine) commandLine->gpu.cacheDirectory = *value();
+            i++;
+        } else {
+            std::cout << "An error occured when trying to parse " << flag << ", unknown flag or missing value!\n";
+            return false;
+        }
+
+        if (processFlag && !commandLine) {
+            std::cout << "An error occured when trying to parse " << flag << ", it is only allowed on the command line!\n";
+            return false;
+        }
+
+        if (!valid) {
+            std::cout << "An error occured when trying to parse the value of " << flag << "!\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool IsJobComplete(const RenderJob &job) {
+    return job.request.width > 0 && job.request.height > 0 && job.request.iterations > 0 && !job.filepath.empty();
+}
+
+static bool ReadBatchFile(const std::string &path, const RenderJob &defaults, std::vector<RenderJob> &jobs) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "An error occured when trying to open " << path << "!\n";
+        return false;
+    }
+
+    std::string line;
+    int number = 0;
+
+    while (std::getline(file, line)) {
+        number++;
+
+        // Blank lines and # comments are skipped
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream stream(line);
+        std::vector<std::string> args;
+        std::string arg;
+
+        while (stream >> arg) args.push_back(arg);
+        if (args.empty()) continue;
+
+        RenderJob job = defaults;
+        std::string nestedBatch;
+
+        if (!ParseArguments(args, job, nullptr, nestedBatch)) {
+            std::cout << "In " << path << " line " << number << "\n";
+            return false;
+        }
+
+        if (!IsJobComplete(job)) {
+            std::cout << "An error occured when trying to read " << path << " line " << number << ", width, height, iterations and output are required!\n";
+            return false;
+        }
+
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+bool ParseCommandLine(int argc, char **argv, CommandLine &commandLine) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    for (const std::string &arg : args) {
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+
+    RenderJob job;
+    std::string batchPath;
+
+    // Same defaults as the GUI's starting view
+    job.request.width = 800;
+    job.request.height = 600;
+    job.request.resolution = 256;
+    job.request.iterations = 100;
+
+    if (!ParseArguments(args, job, &commandLine, batchPath)) return false;
+
+    if (!batchPath.empty()) return ReadBatchFile(batchPath, job, commandLine.jobs);
+
+    if (!job.filepath.empty()) {
+        commandLine.jobs.push_back(job);
+        return true;
+    }
+
+    bool frameFlags = false;
+    for (const std::string &arg : args) {
+        if (arg == "--width" || arg == "--height" || arg == "--resolution" || arg == "--iterations" || arg == "--pivot") frameFlags = true;
+    }
+
+    if (frameFlags) {
+        std::cout << "An error occured when trying to parse the command line, --output is required!\n";
+        return false;
+    }
+
+    return true;
+}
+
+int RunRenderJobs(RenderBackend &backend, const CommandLine &commandLine) {
+    const std::vector<RenderJob> &jobs = commandLine.jobs;
+    const std::string &resumePath = commandLine.resumePath;
+
+    int failures = 0;
+
+    // Tiles need the escape counts, which the shader backends never keep on the host
+    std::unique_ptr<TileCache> tileCache;
+    std::unique_ptr<TiledBackend> tiledBackend;
+
+    if (!commandLine.tileCachePath.empty()) {
+        if (backend.GetIterations()) {
+            tileCache.reset(new TileCache(1024, commandLine.tileCachePath));
+            tiledBackend.reset(new TiledBackend(backend, *tileCache));
+        } else {
+            std::cout << "The " << backend.GetName() << " backend keeps no escape counts to cache, --tile-cache is ignored\n";
+        }
+    }
+
+    RenderBackend &renderer = tiledBackend ? (RenderBackend &) *tiledBackend : backend;
+
+    // Tiles are rendered as many small frames, none of which is the view the state was saved for
+    Continuation *continuation = resumePath.empty() || tiledBackend ? nullptr : backend.GetContinuation();
+
+    if (!resumePath.empty() && !continuation) {
+        if (tiledBackend) std::cout << "Tiled renders can't be resumed, --resume is ignored\n";
+        else std::cout << "The " << backend.GetName() << " backend can't resume renders, --resume is ignored\n";
+    }
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        std::cout << "[" << i + 1 << "/" << jobs.size() << "] " << jobs[i].filepath << " : ";
+
+        // A saved state of another view is no use, the job starts a new one
+        if (continuation) {
+            int x, y;
+            if (!continuation->Load(resumePath, backend.GetName()) || !continuation->Locate(jobs[i].request, x, y)) continuation->Reset(jobs[i].request);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        int result = RenderToFile(renderer, jobs[i].request, jobs[i].filepath);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (result != 0) failures++;
+        else if (continuation) continuation->Save(resumePath, backend.GetName());
+
+        std::cout << " (" << std::chrono::duration<double, std::milli>(end - start).count() << "ms)\n";
+    }
+
+    if (tiledBackend) {
+        std::cout << "Tiles rendered " << tiledBackend->GetRenderedTiles() << ", found in memory " << tileCache->GetHits() << ", found on disk " << tileCache->GetDiskHits() << "\n";
+    }
+
+    if (failures > 0) {
+        std::cout << failures << " of " << jobs.size() << " jobs failed\n";
+        return -1;
+    }
+
+    return 0;
+}
+
+int RunCommandLine(RenderBackend &backend, const CommandLine &commandLine) {
+    if (commandLine.jobs.empty()) return RunPromptedRender(backend);
+
+    return RunRenderJobs(backend, commandLine);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/render.hpp"
+#include "core/multithreaded-backend.hpp"
+#include "core/gpu-backend.hpp"
+
+struct RenderJob {
+    RenderRequest request;
+    std::string filepath;
+};
+
+// Jobs and backend settings given to a render executable. No jobs means the executable falls back to prompting
+struct CommandLine {
+    std::vector<RenderJob> jobs;
+
+    // Only read by the backends they apply to
+    MultiThreadedOptions threading;
+    GpuOptions gpu;
+
+    // Render state file, loaded before every job and saved after it
+    std::string resumePath;
+
+    // Spill directory of the tile cache, frames at power of two resolutions are assembled from its tiles
+    std::string tileCachePath;
+};
+
+// Reads flags into commandLine. Frame flags set up a single job, or act as defaults for every line of a batch file.
+// Prints the problem and returns false on bad input
+bool ParseCommandLine(int argc, char **argv, CommandLine &commandLine);
+
+void PrintUsage(const char *program);
+
+// Renders every job of commandLine with the same backend, so setup is only paid once. With a resume path, a job of
+// the view saved there only iterates the pixels that hadn't escaped by its limit. With a tile cache path, jobs only
+// render the tiles no earlier job or run has. Returns the process exit code
+int RunRenderJobs(RenderBackend &backend, const CommandLine &commandLine);
+
+// Runs the parsed jobs, or prompts for one when there are none. Returns the process exit code
+int RunCommandLine(RenderBackend &backend, const CommandLine &commandLine);
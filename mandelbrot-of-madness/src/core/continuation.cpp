@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "core/continuation.hpp"
+#include "core/bigfloat.hpp"
+
+static const char continuationMagic[4] = {'M', 'B', 'C', 'N'};
+static const uint32_t continuationVersion = 2;
+
+// Region offsets further than this from a whole pixel belong to a different pixel grid
+static const double pixelAlignmentTolerance = 1e-3;
+
+void Continuation::Reset(const RenderRequest &frame) {
+    this->frame = frame;
+
+    size_t size = (size_t) frame.width * frame.height;
+
+    states.assign(size, PixelState::Unknown);
+    counts.assign(size, 0);
+    orbitReal.assign(size, 0);
+    orbitImag.assign(size, 0);
+    references.assign(size, 0);
+
+    referenceReal.clear();
+    referenceImag.clear();
+}
+
+void Continuation::Clear() {
+    frame = RenderRequest();
+
+    states = std::vector<PixelState>();
+    counts = std::vector<uint32_t>();
+    orbitReal = std::vector<double>();
+    orbitImag = std::vector<double>();
+    references = std::vector<uint32_t>();
+
+    referenceReal.clear();
+    referenceImag.clear();
+}
+
+bool Continuation::FindOffset(const RenderRequest &request, int &x, int &y) const {
+    if (IsEmpty()) return false;
+
+    if (request.resolution != frame.resolution || !HasSameFractal(request, frame) || request.mode != frame.mode ||
+        request.bulbCheck != frame.bulbCheck || request.periodTolerance != frame.periodTolerance) return false;
+
+    double offsetReal = request.pivot.real() - frame.pivot.real();
+    double offsetImag = request.pivot.imag() - frame.pivot.imag();
+
+    // Past double precision the offset can only be taken from the decimal pivots
+    int limbs = BigFloat::LimbsForResolution(frame.resolution * std::max(frame.width, frame.height));
+
+    if (!request.deepPivotReal.empty() && !frame.deepPivotReal.empty()) {
+        offsetReal = (BigFloat::FromString(request.deepPivotReal, limbs) - BigFloat::FromString(frame.deepPivotReal, limbs)).ToDouble();
+    }
+
+    if (!request.deepPivotImag.empty() && !frame.deepPivotImag.empty()) {
+        offsetImag = (BigFloat::FromString(request.deepPivotImag, limbs) - BigFloat::FromString(frame.deepPivotImag, limbs)).ToDouble();
+    }
+
+    // Inverse of RegionRequest
+    double regionX = offsetReal * frame.resolution - (float) request.width / 2.0f + (float) frame.width / 2.0f;
+    double regionY = offsetImag * frame.resolution - (float) request.height / 2.0f + (float) frame.height / 2.0f;
+
+    x = (int) std::lround(regionX);
+    y = (int) std::lround(regionY);
+
+    return std::abs(regionX - x) <= pixelAlignmentTolerance && std::abs(regionY - y) <= pixelAlignmentTolerance;
+}
+
+bool Continuation::Locate(const RenderRequest &request, int &x, int &y) const {
+    if (!FindOffset(request, x, y)) return false;
+
+    return x >= 0 && y >= 0 && x + request.width <= frame.width && y + request.height <= frame.height;
+}
+
+void Continuation::Reframe(const RenderRequest &frame) {
+    int offsetX, offsetY;
+
+    if (!FindOffset(frame, offsetX, offsetY)) {
+        Reset(frame);
+        return;
+    }
+
+    Continuation moved;
+    moved.Reset(frame);
+    moved.SetReference(referenceReal, referenceImag);
+
+    // Overlap of the two frames in the coordinates of the new one
+    int left = std::max(0, -offsetX);
+    int right = std::min(frame.width, this->frame.width - offsetX);
+    int top = std::max(0, -offsetY);
+    int bottom = std::min(frame.height, this->frame.height - offsetY);
+
+    for (int y = top; y < bottom && left < right; y++) {
+        size_t from = Index(left + offsetX, y + offsetY);
+        size_t to = moved.Index(left, y);
+        size_t count = right - left;
+
+        std::copy_n(states.begin() + from, count, moved.states.begin() + to);
+        std::copy_n(counts.begin() + from, count, moved.counts.begin() + to);
+        std::copy_n(orbitReal.begin() + from, count, moved.orbitReal.begin() + to);
+        std::copy_n(orbitImag.begin() + from, count, moved.orbitImag.begin() + to);
+        std::copy_n(references.begin() + from, count, moved.references.begin() + to);
+    }
+
+    *this = std::move(moved);
+}
+
+static void WriteString(std::ofstream &file, const std::string &text) {
+    uint32_t length = text.size();
+    file.write((const char *) &length, sizeof(length));
+    file.write(text.data(), length);
+}
+
+static bool ReadString(std::ifstream &file, std::string &text) {
+    uint32_t length = 0;
+    if (!file.read((char *) &length, sizeof(length)) || length > (1 << 20)) return false;
+
+    text.resize(length);
+    return (bool) file.read(&text[0], length);
+}
+
+template <typename T>
+static void WriteValue(std::ofstream &file, const T &value) {
+    file.write((const char *) &value, sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(std::ifstream &file, T &value) {
+    return (bool) file.read((char *) &value, sizeof(T));
+}
+
+template <typename T>
+static void WriteArray(std::ofstream &file, const std::vector<T> &values) {
+    file.write((const char *) values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+static bool ReadArray(std::ifstream &file, std::vector<T> &values) {
+    return (bool) file.read((char *) values.data(), values.size() * sizeof(T));
+}
+
+bool Continuation::Save(const std::string &filepath, const std::string &backend) const {
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) {
+        std::cout << "An error occured when trying to open " << filepath << "!\n";
+        return false;
+    }
+
+    file.write(continuationMagic, sizeof(continuationMagic));
+    WriteValue(file, continuationVersion);
+    WriteString(file, backend);
+
+    WriteValue<int32_t>(file, frame.width);
+    WriteValue<int32_t>(file, frame.height);
+    WriteValue(file, frame.resolution);
+    WriteValue(file, frame.pivot.real());
+    WriteValue(file, frame.pivot.imag());
+    WriteString(file, frame.deepPivotReal);
+    WriteString(file, frame.deepPivotImag);
+    WriteValue<int32_t>(file, (int32_t) frame.fractal);
+    WriteValue(file, frame.juliaSeed.real());
+    WriteValue(file, frame.juliaSeed.imag());
+    WriteValue<int32_t>(file, frame.power);
+    WriteValue<int32_t>(file, (int32_t) frame.mode);
+    WriteValue<uint8_t>(file, frame.bulbCheck);
+    WriteValue(file, frame.periodTolerance);
+    WriteString(file, referenceReal);
+    WriteString(file, referenceImag);
+
+    WriteArray(file, states);
+    WriteArray(file, counts);
+    WriteArray(file, orbitReal);
+    WriteArray(file, orbitImag);
+    WriteArray(file, references);
+
+    if (!file) {
+        std::cout << "An error occured when trying to write " << filepath << "!\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool Continuation::Load(const std::string &filepath, const std::string &backend) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    char magic[4];
+    uint32_t version = 0;
+
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, continuationMagic) || !ReadValue(file, version) || version != continuationVersion) {
+        std::cout << "An error occured when trying to read " << filepath << ", it is not a saved render state!\n";
+        return false;
+    }
+
+    std::string savedBackend;
+    if (!ReadString(file, savedBackend) || savedBackend != backend) {
+        std::cout << "An error occured when trying to read " << filepath << ", it was saved by another backend!\n";
+        return false;
+    }
+
+    RenderRequest saved;
+    int32_t width = 0, height = 0, fractal = 0, power = 0, mode = 0;
+    double real = 0, imag = 0, seedReal = 0, seedImag = 0;
+    uint8_t bulbCheck = 0;
+    std::string savedReferenceReal, savedReferenceImag;
+
+    bool valid = ReadValue(file, width) && ReadValue(file, height) && ReadValue(file, saved.resolution) &&
+                 ReadValue(file, real) && ReadValue(file, imag) &&
+                 ReadString(file, saved.deepPivotReal) && ReadString(file, saved.deepPivotImag) &&
+                 ReadValue(file, fractal) && ReadValue(file, seedReal) && ReadValue(file, seedImag) && ReadValue(file, power) && ReadValue(file, mode) && ReadValue(file, bulbCheck) && ReadValue(file, saved.periodTolerance) &&
+                 ReadString(file, savedReferenceReal) && ReadString(file, savedReferenceImag);
+
+    valid = valid && width > 0 && height > 0;
+
+    if (valid) {
+        saved.width = width;
+        saved.height = height;
+        saved.pivot = std::complex<double>(real, imag);
+        saved.fractal = (FractalType) fractal;
+        saved.juliaSeed = std::complex<double>(seedReal, seedImag);
+        saved.power = power;
+        saved.mode = (RenderMode) mode;
+        saved.bulbCheck = bulbCheck != 0;
+
+        Reset(saved);
+        SetReference(savedReferenceReal, savedReferenceImag);
+
+        valid = ReadArray(file, states) && ReadArray(file, counts) && ReadArray(file, orbitReal) && ReadArray(file, orbitImag) && ReadArray(file, references);
+    }
+
+    if (!valid) {
+        std::cout << "An error occured when trying to read " << filepath << ", the file is truncated!\n";
+        Clear();
+        return false;
+    }
+
+    return true;
+}
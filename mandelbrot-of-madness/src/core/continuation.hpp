@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/render.hpp"
+
+enum class PixelState : uint8_t {
+    // Not computed yet
+    Unknown,
+
+    // Escaped at its stored count
+    Escaped,
+
+    // In the set through the bulb test or a closed cycle, whatever the iteration limit
+    Interior,
+
+    // Hit the iteration limit at its stored count with the orbit still going, the saved z lets it carry on
+    Running
+};
+
+// Per-pixel orbit state of a frame, so that raising the iteration limit of the same view only iterates the pixels
+// that were still running instead of starting every one of them over from z = 0. Renders of a pixel aligned region
+// of the frame, like the bands of the GUI or of a streamed render, read and update their part of it
+class Continuation {
+public:
+    // Starts over with every pixel of frame unknown. The iteration limit of frame doesn't matter, every pixel
+    // remembers the one it was last computed to
+    void Reset(const RenderRequest &frame);
+    void Clear();
+
+    bool IsEmpty() const { return states.empty(); }
+    const RenderRequest &GetFrame() const { return frame; }
+
+    // Finds the offset of request inside the frame. False when it has other settings or isn't a pixel aligned region of it
+    bool Locate(const RenderRequest &request, int &x, int &y) const;
+
+    // Moves the state over to frame, which has to be a pixel aligned shift of the current one with the same settings,
+    // so after a pan only the newly exposed pixels are unknown. Anything else starts over
+    void Reframe(const RenderRequest &frame);
+
+    // Binary dump of the frame and its state, so a CLI render can pick up a saved view in a later run. The orbit
+    // state means something else to every backend, so only the one that saved it can load it
+    bool Save(const std::string &filepath, const std::string &backend) const;
+    bool Load(const std::string &filepath, const std::string &backend);
+
+    size_t Index(int x, int y) const { return (size_t) y * frame.width + x; }
+
+    PixelState *GetStates() { return states.data(); }
+    uint32_t *GetCounts() { return counts.data(); }
+    double *GetOrbitReal() { return orbitReal.data(); }
+    double *GetOrbitImag() { return orbitImag.data(); }
+
+    // Position in the reference orbit that z is an offset from, only used by the perturbation backend
+    uint32_t *GetReferences() { return references.data(); }
+
+    // Decimal reference point the perturbation offsets belong to, empty until the first deep render stores one
+    const std::string &GetReferenceReal() const { return referenceReal; }
+    const std::string &GetReferenceImag() const { return referenceImag; }
+
+    void SetReference(const std::string &real, const std::string &imag) {
+        referenceReal = real;
+        referenceImag = imag;
+    }
+
+private:
+    // Position of request's first pixel in the frame, which may lie outside of it
+    bool FindOffset(const RenderRequest &request, int &x, int &y) const;
+
+    RenderRequest frame;
+
+    std::vector<PixelState> states;
+    std::vector<uint32_t> counts;
+    std::vector<double> orbitReal;
+    std::vector<double> orbitImag;
+    std::vector<uint32_t> references;
+
+    std::string referenceReal;
+    std::string referenceImag;
+};
@@ -0,0 +1,96 @@
+#include <atomic>
+
+#include "core/cpu-features.hpp"
+
+#if defined(MANDELBROT_X86_SIMD)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+
+    for (int i = 0; i < 4; i++) {
+        registers[i] = r[i];
+    }
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static unsigned long long ReadXcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax;
+    unsigned int edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long) edx << 32) | eax;
+#endif
+}
+
+static SimdLevel QuerySimdLevel() {
+    unsigned int registers[4];
+
+    Cpuid(0, 0, registers);
+    unsigned int maxLeaf = registers[0];
+
+    if (maxLeaf < 7) return SimdLevel::Scalar;
+
+    Cpuid(1, 0, registers);
+    bool fma = registers[2] & (1u << 12);
+    bool osxsave = registers[2] & (1u << 27);
+    bool avx = registers[2] & (1u << 28);
+
+    if (!fma || !osxsave || !avx) return SimdLevel::Scalar;
+
+    // The OS has to save the YMM (and for AVX-512 the opmask and ZMM) state on context switches
+    unsigned long long xcr0 = ReadXcr0();
+    if ((xcr0 & 0x6) != 0x6) return SimdLevel::Scalar;
+
+    Cpuid(7, 0, registers);
+    bool avx2 = registers[1] & (1u << 5);
+    bool avx512f = registers[1] & (1u << 16);
+
+    if (avx512f && (xcr0 & 0xE6) == 0xE6) return SimdLevel::Avx512;
+    if (avx2) return SimdLevel::Avx2;
+
+    return SimdLevel::Scalar;
+}
+#else
+static SimdLevel QuerySimdLevel() {
+    return SimdLevel::Scalar;
+}
+#endif
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel detected = QuerySimdLevel();
+    return detected;
+}
+
+static std::atomic<int> forcedLevel = -1;
+
+SimdLevel GetSimdLevel() {
+    int forced = forcedLevel.load(std::memory_order_relaxed);
+    return forced < 0 ? DetectSimdLevel() : (SimdLevel) forced;
+}
+
+void ForceSimdLevel(SimdLevel level) {
+    if ((int) level > (int) DetectSimdLevel()) {
+        level = DetectSimdLevel();
+    }
+
+    forcedLevel.store((int) level, std::memory_order_relaxed);
+}
+
+const char *GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "AVX2";
+        case SimdLevel::Avx512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+enum class SimdLevel {
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+// Widest instruction set the CPU and OS both support, detected once through CPUID
+SimdLevel DetectSimdLevel();
+
+// Instruction set the CPU kernels currently dispatch to
+SimdLevel GetSimdLevel();
+
+// Overrides the dispatched instruction set, clamped to what DetectSimdLevel reports
+void ForceSimdLevel(SimdLevel level);
+
+const char *GetSimdLevelName(SimdLevel level);
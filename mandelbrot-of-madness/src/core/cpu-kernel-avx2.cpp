@@ -0,0 +1,189 @@
+#if defined(MANDELBROT_X86_SIMD)
+#include <immintrin.h>
+#include <limits>
+
+#include "core/cpu-kernel.hpp"
+#include "core/cpu-kernel-simd.hpp"
+
+// Only the kernels below are built for AVX2. The file itself is built for the baseline, so the inline functions and
+// templates it instantiates from the headers, which the linker may keep for every other file, never use AVX2
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+// Vector versions of the formula steps, 4 orbits at once
+AVX2_TARGET static inline void Step(MandelbrotFormula, __m256d &zr, __m256d &zi, __m256d zr2, __m256d zi2, __m256d cr, __m256d ci, int power) {
+    zi = _mm256_fmadd_pd(_mm256_add_pd(zr, zr), zi, ci);
+    zr = _mm256_add_pd(_mm256_sub_pd(zr2, zi2), cr);
+}
+
+template <int Power>
+AVX2_TARGET static inline void Step(MultibrotFormula<Power>, __m256d &zr, __m256d &zi, __m256d zr2, __m256d zi2, __m256d cr, __m256d ci, int power) {
+    int exponent = Power > 0 ? Power : power;
+    __m256d wr = zr, wi = zi;
+
+    for (int p = 1; p < exponent; p++) {
+        __m256d t = _mm256_fmsub_pd(wr, zr, _mm256_mul_pd(wi, zi));
+        wi = _mm256_fmadd_pd(wr, zi, _mm256_mul_pd(wi, zr));
+        wr = t;
+    }
+
+    zr = _mm256_add_pd(wr, cr);
+    zi = _mm256_add_pd(wi, ci);
+}
+
+AVX2_TARGET static inline void Step(BurningShipFormula, __m256d &zr, __m256d &zi, __m256d zr2, __m256d zi2, __m256d cr, __m256d ci, int power) {
+    __m256d product = _mm256_andnot_pd(_mm256_set1_pd(-0.0), _mm256_mul_pd(zr, zi));
+
+    zi = _mm256_add_pd(_mm256_add_pd(product, product), ci);
+    zr = _mm256_add_pd(_mm256_sub_pd(zr2, zi2), cr);
+}
+
+// 4 pixels per lane group. Lanes that escape drop out of the alive mask and stop counting
+template <typename Formula>
+AVX2_TARGET static void CalculateSpanAvx2(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    int iterations = request.iterations;
+    int power = request.power;
+
+    __m256d pivotReal = _mm256_set1_pd(request.pivot.real());
+    __m256d pivotImag = _mm256_set1_pd(request.pivot.imag());
+    __m256d halfWidth = _mm256_set1_pd((float) request.width / 2.0f);
+    __m256d halfHeight = _mm256_set1_pd((float) request.height / 2.0f);
+    __m256d resolution = _mm256_set1_pd(request.resolution);
+    __m256d laneOffsets = _mm256_set_pd(3, 2, 1, 0);
+    __m256d bailout = _mm256_set1_pd(GetBailout<Formula>(request));
+    __m256d seedReal = _mm256_set1_pd(request.juliaSeed.real());
+    __m256d seedImag = _mm256_set1_pd(request.juliaSeed.imag());
+    __m256d one = _mm256_set1_pd(1);
+    __m256d quarter = _mm256_set1_pd(0.25);
+    __m256d sixteenth = _mm256_set1_pd(0.0625);
+    __m256d total = _mm256_set1_pd(iterations);
+    __m256d tolerance2 = _mm256_set1_pd(PeriodToleranceSquared(request));
+    bool checkPeriod = request.periodTolerance > 0;
+
+    int stride = vertical ? request.width : 1;
+    uint32_t *out = counts + y * request.width + x;
+    float *fractionOut = fractions ? fractions + y * request.width + x : nullptr;
+    double *orbitOut = orbits ? orbits + 2 * (y * request.width + x) : nullptr;
+
+    __m256d laneX = vertical ? _mm256_setzero_pd() : laneOffsets;
+    __m256d laneY = vertical ? laneOffsets : _mm256_setzero_pd();
+
+    int k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256d px = _mm256_add_pd(_mm256_set1_pd(vertical ? x : x + k), laneX);
+        __m256d py = _mm256_add_pd(_mm256_set1_pd(vertical ? y + k : y), laneY);
+        __m256d pointReal = _mm256_add_pd(pivotReal, _mm256_div_pd(_mm256_sub_pd(px, halfWidth), resolution));
+        __m256d pointImag = _mm256_add_pd(pivotImag, _mm256_div_pd(_mm256_sub_pd(py, halfHeight), resolution));
+
+        __m256d cr = Formula::julia ? seedReal : pointReal;
+        __m256d ci = Formula::julia ? seedImag : pointImag;
+        __m256d ci2 = _mm256_mul_pd(ci, ci);
+
+        __m256d zr = Formula::julia ? pointReal : _mm256_setzero_pd();
+        __m256d zi = Formula::julia ? pointImag : _mm256_setzero_pd();
+        __m256d zr2 = _mm256_mul_pd(zr, zr);
+        __m256d zi2 = _mm256_mul_pd(zi, zi);
+        __m256d iters = _mm256_setzero_pd();
+        __m256d sr = zr;
+        __m256d si = zi;
+        int nextSave = 1;
+
+        // |z|^2 of every lane at the last check it was alive for, which is its escape for lanes that escaped
+        __m256d escapeNorm = _mm256_setzero_pd();
+        __m256d interior = _mm256_setzero_pd();
+
+        if (Formula::bulbs && request.bulbCheck) {
+            __m256d xr = _mm256_sub_pd(cr, quarter);
+            __m256d q = _mm256_fmadd_pd(xr, xr, ci2);
+            __m256d cardioid = _mm256_cmp_pd(_mm256_mul_pd(q, _mm256_add_pd(q, xr)), _mm256_mul_pd(quarter, ci2), _CMP_LE_OQ);
+
+            __m256d br = _mm256_add_pd(cr, one);
+            __m256d bulb = _mm256_cmp_pd(_mm256_fmadd_pd(br, br, ci2), sixteenth, _CMP_LE_OQ);
+
+            interior = _mm256_or_pd(cardioid, bulb);
+        }
+
+        // Interior lanes never join the loop and take the full count afterwards
+        __m256d alive = _mm256_xor_pd(interior, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)));
+
+        for (int iter = 0; iter < iterations; iter++) {
+            __m256d norm = _mm256_add_pd(zr2, zi2);
+            if (fractionOut) escapeNorm = _mm256_blendv_pd(escapeNorm, norm, alive);
+
+            alive = _mm256_and_pd(alive, _mm256_cmp_pd(norm, bailout, _CMP_LT_OQ));
+            if (_mm256_movemask_pd(alive) == 0) break;
+
+            iters = _mm256_add_pd(iters, _mm256_and_pd(alive, one));
+
+            Step(Formula(), zr, zi, zr2, zi2, cr, ci, power);
+            zr2 = _mm256_mul_pd(zr, zr);
+            zi2 = _mm256_mul_pd(zi, zi);
+
+            // Brent's cycle detection, periodic lanes leave the loop as interior points
+            if (checkPeriod) {
+                __m256d dr = _mm256_sub_pd(zr, sr);
+                __m256d di = _mm256_sub_pd(zi, si);
+                __m256d cycled = _mm256_and_pd(alive, _mm256_cmp_pd(_mm256_fmadd_pd(dr, dr, _mm256_mul_pd(di, di)), tolerance2, _CMP_LT_OQ));
+
+                interior = _mm256_or_pd(interior, cycled);
+                alive = _mm256_andnot_pd(cycled, alive);
+
+                if (iter == nextSave) {
+                    sr = zr;
+                    si = zi;
+                    nextSave *= 2;
+                }
+            }
+        }
+
+        iters = _mm256_blendv_pd(iters, total, interior);
+
+        __m128i result = _mm256_cvttpd_epi32(iters);
+
+        if (vertical) {
+            uint32_t lanes[4];
+            _mm_storeu_si128((__m128i *) lanes, result);
+
+            for (int lane = 0; lane < 4; lane++) {
+                out[(k + lane) * stride] = lanes[lane];
+            }
+        } else {
+            _mm_storeu_si128((__m128i *) (out + k), result);
+        }
+
+        if (fractionOut) {
+            uint32_t lanes[4];
+            double norms[4];
+            _mm_storeu_si128((__m128i *) lanes, result);
+            _mm256_storeu_pd(norms, escapeNorm);
+
+            for (int lane = 0; lane < 4; lane++) {
+                fractionOut[(k + lane) * stride] = lanes[lane] < (uint32_t) iterations ? GetSmoothFraction(request, norms[lane]) : 0;
+            }
+        }
+
+        if (orbitOut) {
+            double lanesReal[4];
+            double lanesImag[4];
+            _mm256_storeu_pd(lanesReal, _mm256_blendv_pd(zr, _mm256_set1_pd(std::numeric_limits<double>::quiet_NaN()), interior));
+            _mm256_storeu_pd(lanesImag, zi);
+
+            for (int lane = 0; lane < 4; lane++) {
+                orbitOut[2 * (k + lane) * stride] = lanesReal[lane];
+                orbitOut[2 * (k + lane) * stride + 1] = lanesImag[lane];
+            }
+        }
+    }
+
+    CalculateSpanScalar(counts, fractions, orbits, request, vertical ? x : x + k, vertical ? y + k : y, count - k, vertical);
+}
+
+void CalculateSpanAvx2(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    VisitFormula(request, [&](auto formula) {
+        CalculateSpanAvx2<decltype(formula)>(counts, fractions, orbits, request, x, y, count, vertical);
+    });
+}
+#endif
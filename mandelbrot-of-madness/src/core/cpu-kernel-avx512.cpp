@@ -0,0 +1,189 @@
+#if defined(MANDELBROT_X86_SIMD)
+#include <immintrin.h>
+#include <limits>
+
+#include "core/cpu-kernel.hpp"
+#include "core/cpu-kernel-simd.hpp"
+
+// Only the kernels below are built for AVX-512. The file itself is built for the baseline, so the inline functions and
+// templates it instantiates from the headers, which the linker may keep for every other file, never use AVX-512
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AVX512_TARGET
+#else
+#define AVX512_TARGET __attribute__((target("avx512f")))
+#endif
+
+// Vector versions of the formula steps, 8 orbits at once
+AVX512_TARGET static inline void Step(MandelbrotFormula, __m512d &zr, __m512d &zi, __m512d zr2, __m512d zi2, __m512d cr, __m512d ci, int power) {
+    zi = _mm512_fmadd_pd(_mm512_add_pd(zr, zr), zi, ci);
+    zr = _mm512_add_pd(_mm512_sub_pd(zr2, zi2), cr);
+}
+
+template <int Power>
+AVX512_TARGET static inline void Step(MultibrotFormula<Power>, __m512d &zr, __m512d &zi, __m512d zr2, __m512d zi2, __m512d cr, __m512d ci, int power) {
+    int exponent = Power > 0 ? Power : power;
+    __m512d wr = zr, wi = zi;
+
+    for (int p = 1; p < exponent; p++) {
+        __m512d t = _mm512_fmsub_pd(wr, zr, _mm512_mul_pd(wi, zi));
+        wi = _mm512_fmadd_pd(wr, zi, _mm512_mul_pd(wi, zr));
+        wr = t;
+    }
+
+    zr = _mm512_add_pd(wr, cr);
+    zi = _mm512_add_pd(wi, ci);
+}
+
+AVX512_TARGET static inline void Step(BurningShipFormula, __m512d &zr, __m512d &zi, __m512d zr2, __m512d zi2, __m512d cr, __m512d ci, int power) {
+    __m512d product = _mm512_abs_pd(_mm512_mul_pd(zr, zi));
+
+    zi = _mm512_add_pd(_mm512_add_pd(product, product), ci);
+    zr = _mm512_add_pd(_mm512_sub_pd(zr2, zi2), cr);
+}
+
+// 8 pixels per lane group, with the escape state kept in an opmask register
+template <typename Formula>
+AVX512_TARGET static void CalculateSpanAvx512(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    int iterations = request.iterations;
+    int power = request.power;
+
+    __m512d pivotReal = _mm512_set1_pd(request.pivot.real());
+    __m512d pivotImag = _mm512_set1_pd(request.pivot.imag());
+    __m512d halfWidth = _mm512_set1_pd((float) request.width / 2.0f);
+    __m512d halfHeight = _mm512_set1_pd((float) request.height / 2.0f);
+    __m512d resolution = _mm512_set1_pd(request.resolution);
+    __m512d laneOffsets = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+    __m512d bailout = _mm512_set1_pd(GetBailout<Formula>(request));
+    __m512d seedReal = _mm512_set1_pd(request.juliaSeed.real());
+    __m512d seedImag = _mm512_set1_pd(request.juliaSeed.imag());
+    __m512d one = _mm512_set1_pd(1);
+    __m512d quarter = _mm512_set1_pd(0.25);
+    __m512d sixteenth = _mm512_set1_pd(0.0625);
+    __m512d total = _mm512_set1_pd(iterations);
+    __m512d tolerance2 = _mm512_set1_pd(PeriodToleranceSquared(request));
+    bool checkPeriod = request.periodTolerance > 0;
+
+    int stride = vertical ? request.width : 1;
+    uint32_t *out = counts + y * request.width + x;
+    float *fractionOut = fractions ? fractions + y * request.width + x : nullptr;
+    double *orbitOut = orbits ? orbits + 2 * (y * request.width + x) : nullptr;
+
+    __m512d laneX = vertical ? _mm512_setzero_pd() : laneOffsets;
+    __m512d laneY = vertical ? laneOffsets : _mm512_setzero_pd();
+
+    int k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m512d px = _mm512_add_pd(_mm512_set1_pd(vertical ? x : x + k), laneX);
+        __m512d py = _mm512_add_pd(_mm512_set1_pd(vertical ? y + k : y), laneY);
+        __m512d pointReal = _mm512_add_pd(pivotReal, _mm512_div_pd(_mm512_sub_pd(px, halfWidth), resolution));
+        __m512d pointImag = _mm512_add_pd(pivotImag, _mm512_div_pd(_mm512_sub_pd(py, halfHeight), resolution));
+
+        __m512d cr = Formula::julia ? seedReal : pointReal;
+        __m512d ci = Formula::julia ? seedImag : pointImag;
+        __m512d ci2 = _mm512_mul_pd(ci, ci);
+
+        __m512d zr = Formula::julia ? pointReal : _mm512_setzero_pd();
+        __m512d zi = Formula::julia ? pointImag : _mm512_setzero_pd();
+        __m512d zr2 = _mm512_mul_pd(zr, zr);
+        __m512d zi2 = _mm512_mul_pd(zi, zi);
+        __m512d iters = _mm512_setzero_pd();
+        __m512d sr = zr;
+        __m512d si = zi;
+        int nextSave = 1;
+
+        // |z|^2 of every lane at the last check it was alive for, which is its escape for lanes that escaped
+        __m512d escapeNorm = _mm512_setzero_pd();
+        __mmask8 interior = 0;
+
+        if (Formula::bulbs && request.bulbCheck) {
+            __m512d xr = _mm512_sub_pd(cr, quarter);
+            __m512d q = _mm512_fmadd_pd(xr, xr, ci2);
+            __mmask8 cardioid = _mm512_cmp_pd_mask(_mm512_mul_pd(q, _mm512_add_pd(q, xr)), _mm512_mul_pd(quarter, ci2), _CMP_LE_OQ);
+
+            __m512d br = _mm512_add_pd(cr, one);
+            __mmask8 bulb = _mm512_cmp_pd_mask(_mm512_fmadd_pd(br, br, ci2), sixteenth, _CMP_LE_OQ);
+
+            interior = cardioid | bulb;
+        }
+
+        // Interior lanes never join the loop and take the full count afterwards
+        __mmask8 alive = ~interior;
+
+        for (int iter = 0; iter < iterations; iter++) {
+            __m512d norm = _mm512_add_pd(zr2, zi2);
+            if (fractionOut) escapeNorm = _mm512_mask_mov_pd(escapeNorm, alive, norm);
+
+            alive = _mm512_mask_cmp_pd_mask(alive, norm, bailout, _CMP_LT_OQ);
+            if (alive == 0) break;
+
+            iters = _mm512_mask_add_pd(iters, alive, iters, one);
+
+            Step(Formula(), zr, zi, zr2, zi2, cr, ci, power);
+            zr2 = _mm512_mul_pd(zr, zr);
+            zi2 = _mm512_mul_pd(zi, zi);
+
+            // Brent's cycle detection, periodic lanes leave the loop as interior points
+            if (checkPeriod) {
+                __m512d dr = _mm512_sub_pd(zr, sr);
+                __m512d di = _mm512_sub_pd(zi, si);
+                __mmask8 cycled = _mm512_mask_cmp_pd_mask(alive, _mm512_fmadd_pd(dr, dr, _mm512_mul_pd(di, di)), tolerance2, _CMP_LT_OQ);
+
+                interior |= cycled;
+                alive &= ~cycled;
+
+                if (iter == nextSave) {
+                    sr = zr;
+                    si = zi;
+                    nextSave *= 2;
+                }
+            }
+        }
+
+        iters = _mm512_mask_blend_pd(interior, iters, total);
+
+        __m256i result = _mm512_cvttpd_epi32(iters);
+
+        if (vertical) {
+            uint32_t lanes[8];
+            _mm256_storeu_si256((__m256i *) lanes, result);
+
+            for (int lane = 0; lane < 8; lane++) {
+                out[(k + lane) * stride] = lanes[lane];
+            }
+        } else {
+            _mm256_storeu_si256((__m256i *) (out + k), result);
+        }
+
+        if (fractionOut) {
+            uint32_t lanes[8];
+            double norms[8];
+            _mm256_storeu_si256((__m256i *) lanes, result);
+            _mm512_storeu_pd(norms, escapeNorm);
+
+            for (int lane = 0; lane < 8; lane++) {
+                fractionOut[(k + lane) * stride] = lanes[lane] < (uint32_t) iterations ? GetSmoothFraction(request, norms[lane]) : 0;
+            }
+        }
+
+        if (orbitOut) {
+            double lanesReal[8];
+            double lanesImag[8];
+            _mm512_storeu_pd(lanesReal, _mm512_mask_blend_pd(interior, zr, _mm512_set1_pd(std::numeric_limits<double>::quiet_NaN())));
+            _mm512_storeu_pd(lanesImag, zi);
+
+            for (int lane = 0; lane < 8; lane++) {
+                orbitOut[2 * (k + lane) * stride] = lanesReal[lane];
+                orbitOut[2 * (k + lane) * stride + 1] = lanesImag[lane];
+            }
+        }
+    }
+
+    CalculateSpanScalar(counts, fractions, orbits, request, vertical ? x : x + k, vertical ? y + k : y, count - k, vertical);
+}
+
+void CalculateSpanAvx512(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    VisitFormula(request, [&](auto formula) {
+        CalculateSpanAvx512<decltype(formula)>(counts, fractions, orbits, request, x, y, count, vertical);
+    });
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/render.hpp"
+
+// Span kernels fill count escape counts starting at (x, y), going right or, if vertical, down.
+// When fractions isn't null they leave the smooth fraction of every pixel there, 0 for pixels that didn't escape.
+// When orbits isn't null they also leave the last z of every pixel there, real and imaginary parts interleaved
+// at twice the count index, with NaN for interior points. The SIMD variants hand their ragged tail to the scalar one
+void CalculateSpanScalar(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical);
+
+#if defined(MANDELBROT_X86_SIMD)
+void CalculateSpanAvx2(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical);
+void CalculateSpanAvx512(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical);
+#endif
@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <limits>
+
+#include "core/cpu-kernel.hpp"
+#include "core/cpu-kernel-simd.hpp"
+#include "core/cpu-features.hpp"
+#include "core/palette.hpp"
+
+template <typename Formula>
+static void CalculateSpanScalar(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    int iterations = request.iterations;
+    int power = request.power;
+    double bailout = GetBailout<Formula>(request);
+    double tolerance2 = PeriodToleranceSquared(request);
+    bool bulbCheck = Formula::bulbs && request.bulbCheck;
+
+    int stride = vertical ? request.width : 1;
+    uint32_t *out = counts + y * request.width + x;
+    float *fractionOut = fractions ? fractions + y * request.width + x : nullptr;
+    double *orbitOut = orbits ? orbits + 2 * (y * request.width + x) : nullptr;
+
+    for (int k = 0; k < count; k++) {
+        std::complex<double> point = vertical ? PixelToPoint(request, x, y + k) : PixelToPoint(request, x + k, y);
+        double cr = Formula::julia ? request.juliaSeed.real() : point.real();
+        double ci = Formula::julia ? request.juliaSeed.imag() : point.imag();
+
+        if (bulbCheck && InMainCardioidOrBulb(cr, ci)) {
+            out[k * stride] = iterations;
+            if (fractionOut) fractionOut[k * stride] = 0;
+            if (orbitOut) orbitOut[2 * k * stride] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+
+        // Spelled out instead of std::complex so the multiply skips its NaN/Inf recovery
+        double zr = Formula::julia ? point.real() : 0;
+        double zi = Formula::julia ? point.imag() : 0;
+        double zr2 = zr * zr, zi2 = zi * zi;
+
+        // Brent's cycle detection, the saved point moves up to z at every power of two iterations
+        double sr = zr, si = zi;
+        int nextSave = 1;
+
+        int iter = 0;
+        for (; iter < iterations && zr2 + zi2 < bailout; iter++) {
+            Formula::Step(zr, zi, zr2, zi2, cr, ci, power);
+            zr2 = zr * zr;
+            zi2 = zi * zi;
+
+            if (tolerance2 > 0) {
+                double dr = zr - sr;
+                double di = zi - si;
+
+                if (dr * dr + di * di < tolerance2) {
+                    iter = iterations;
+                    zr = std::numeric_limits<double>::quiet_NaN();
+                    break;
+                }
+
+                if (iter == nextSave) {
+                    sr = zr;
+                    si = zi;
+                    nextSave *= 2;
+                }
+            }
+        }
+
+        out[k * stride] = iter;
+        if (fractionOut) fractionOut[k * stride] = iter < iterations ? GetSmoothFraction(request, zr2 + zi2) : 0;
+
+        if (orbitOut) {
+            orbitOut[2 * k * stride] = zr;
+            orbitOut[2 * k * stride + 1] = zi;
+        }
+    }
+}
+
+void CalculateSpanScalar(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical) {
+    VisitFormula(request, [&](auto formula) {
+        CalculateSpanScalar<decltype(formula)>(counts, fractions, orbits, request, x, y, count, vertical);
+    });
+}
+
+typedef void (*SpanKernel)(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count, bool vertical);
+
+static SpanKernel SelectSpanKernel() {
+    switch (GetSimdLevel()) {
+#if defined(MANDELBROT_X86_SIMD)
+        case SimdLevel::Avx512: return CalculateSpanAvx512;
+        case SimdLevel::Avx2: return CalculateSpanAvx2;
+#endif
+        default: return CalculateSpanScalar;
+    }
+}
+
+void CalculateMandelbrotSpan(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count) {
+    SelectSpanKernel()(counts, fractions, orbits, request, x, y, count, false);
+}
+
+template <typename Formula>
+static PixelState ContinueMandelbrot(const RenderRequest &request, double cr, double ci, double &zr, double &zi, uint32_t &count) {
+    int iterations = request.iterations;
+    int power = request.power;
+    double bailout = GetBailout<Formula>(request);
+    double tolerance2 = PeriodToleranceSquared(request);
+
+    if (Formula::julia) {
+        cr = request.juliaSeed.real();
+        ci = request.juliaSeed.imag();
+    }
+
+    double zr2 = zr * zr;
+    double zi2 = zi * zi;
+
+    // Cycle detection starts over from the resumed point, which still finds every period up to the count so far
+    double sr = zr, si = zi;
+    int iter = count;
+    int nextSave = std::max(1, iter * 2);
+
+    for (; iter < iterations && zr2 + zi2 < bailout; iter++) {
+        Formula::Step(zr, zi, zr2, zi2, cr, ci, power);
+        zr2 = zr * zr;
+        zi2 = zi * zi;
+
+        if (tolerance2 > 0) {
+            double dr = zr - sr;
+            double di = zi - si;
+
+            if (dr * dr + di * di < tolerance2) {
+                count = iterations;
+                return PixelState::Interior;
+            }
+
+            if (iter == nextSave) {
+                sr = zr;
+                si = zi;
+                nextSave *= 2;
+            }
+        }
+    }
+
+    count = iter;
+    return iter < iterations ? PixelState::Escaped : PixelState::Running;
+}
+
+PixelState ContinueMandelbrot(const RenderRequest &request, double cr, double ci, double &zr, double &zi, uint32_t &count) {
+    PixelState state = PixelState::Running;
+
+    VisitFormula(request, [&](auto formula) {
+        state = ContinueMandelbrot<decltype(formula)>(request, cr, ci, zr, zi, count);
+    });
+
+    return state;
+}
+
+void CalculateContinuedTile(uint32_t *counts, double *orbits, Continuation &continuation, const RenderRequest &request, int frameX, int frameY,
+                            int x0, int y0, int width, int height) {
+    uint32_t limit = request.iterations;
+
+    PixelState *states = continuation.GetStates();
+    uint32_t *savedCounts = continuation.GetCounts();
+    double *savedReal = continuation.GetOrbitReal();
+    double *savedImag = continuation.GetOrbitImag();
+
+    int right = x0 + width;
+
+    for (int y = y0; y < y0 + height; y++) {
+        size_t frameRow = continuation.Index(frameX, frameY + y);
+        size_t row = (size_t) y * request.width;
+
+        for (int x = x0; x < right;) {
+            size_t i = frameRow + x;
+
+            if (states[i] == PixelState::Unknown) {
+                int end = x + 1;
+                while (end < right && states[frameRow + end] == PixelState::Unknown) end++;
+
+                CalculateMandelbrotSpan(counts, nullptr, orbits, request, x, y, end - x);
+
+                for (; x < end; x++) {
+                    size_t local = row + x;
+                    size_t j = frameRow + x;
+
+                    savedCounts[j] = counts[local];
+
+                    if (counts[local] < limit) {
+                        states[j] = PixelState::Escaped;
+                    } else if (std::isnan(orbits[2 * local])) {
+                        states[j] = PixelState::Interior;
+                    } else {
+                        states[j] = PixelState::Running;
+                        savedReal[j] = orbits[2 * local];
+                        savedImag[j] = orbits[2 * local + 1];
+                    }
+                }
+
+                continue;
+            }
+
+            if (states[i] == PixelState::Running && savedCounts[i] < limit) {
+                std::complex<double> c = PixelToPoint(request, x, y);
+                states[i] = ContinueMandelbrot(request, c.real(), c.imag(), savedReal[i], savedImag[i], savedCounts[i]);
+            }
+
+            // Anything that got further than a lowered limit shows as not escaped
+            counts[row + x] = states[i] == PixelState::Interior ? limit : std::min(savedCounts[i], limit);
+            x++;
+        }
+    }
+}
+
+uint32_t CalculateMandelbrotPoint(const RenderRequest &request, double real, double imag, float *fraction) {
+    if (fraction) *fraction = 0;
+
+    if (request.fractal == FractalType::Mandelbrot && request.bulbCheck && InMainCardioidOrBulb(real, imag)) return request.iterations;
+
+    // A continuation from the start of the orbit, where Julia sets start z at the point
+    bool julia = request.fractal == FractalType::Julia;
+    double zr = julia ? real : 0;
+    double zi = julia ? imag : 0;
+    uint32_t count = 0;
+
+    PixelState state = ContinueMandelbrot(request, real, imag, zr, zi, count);
+    if (fraction && state == PixelState::Escaped) *fraction = GetSmoothFraction(request, zr * zr + zi * zi);
+
+    return count;
+}
+
+void CalculateMandelbrot(uint32_t *counts, float *fractions, const RenderRequest &request, int from, int to) {
+    int width = request.width;
+    SpanKernel kernel = SelectSpanKernel();
+
+    for (int i = from; i < to;) {
+        int y = i / width;
+        int x = i % width;
+        int end = std::min(to - y * width, width);
+
+        kernel(counts, fractions, nullptr, request, x, y, end - x, false);
+
+        i = y * width + end;
+    }
+}
+
+// Rectangles are inclusive of their border, which the caller has already computed
+struct Subdivider {
+    uint32_t *counts;
+    const RenderRequest &request;
+    SpanKernel kernel;
+
+    uint32_t *Row(int y) {
+        return counts + y * request.width;
+    }
+
+    bool IsBorderUniform(int x0, int y0, int x1, int y1) {
+        uint32_t value = Row(y0)[x0];
+
+        for (int x = x0; x <= x1; x++) {
+            if (Row(y0)[x] != value || Row(y1)[x] != value) return false;
+        }
+
+        for (int y = y0 + 1; y < y1; y++) {
+            if (Row(y)[x0] != value || Row(y)[x1] != value) return false;
+        }
+
+        return true;
+    }
+
+    void Subdivide(int x0, int y0, int x1, int y1) {
+        if (x1 - x0 < 2 || y1 - y0 < 2) return;
+
+        if (IsBorderUniform(x0, y0, x1, y1)) {
+            uint32_t value = Row(y0)[x0];
+
+            for (int y = y0 + 1; y < y1; y++) {
+                std::fill(Row(y) + x0 + 1, Row(y) + x1, value);
+            }
+
+            return;
+        }
+
+        // Past this size tracing more borders costs about as much as iterating what's left
+        if (x1 - x0 < 6 || y1 - y0 < 6) {
+            for (int y = y0 + 1; y < y1; y++) {
+                kernel(counts, nullptr, nullptr, request, x0 + 1, y, x1 - x0 - 1, false);
+            }
+
+            return;
+        }
+
+        if (x1 - x0 > y1 - y0) {
+            int mid = (x0 + x1) / 2;
+            kernel(counts, nullptr, nullptr, request, mid, y0 + 1, y1 - y0 - 1, true);
+
+            Subdivide(x0, y0, mid, y1);
+            Subdivide(mid, y0, x1, y1);
+        } else {
+            int mid = (y0 + y1) / 2;
+            kernel(counts, nullptr, nullptr, request, x0 + 1, mid, x1 - x0 - 1, false);
+
+            Subdivide(x0, y0, x1, mid);
+            Subdivide(x0, mid, x1, y1);
+        }
+    }
+};
+
+void CalculateMandelbrotTile(uint32_t *counts, float *fractions, const RenderRequest &request, int x, int y, int width, int height) {
+    SpanKernel kernel = SelectSpanKernel();
+
+    // Filled rectangles would all get the fraction of one border pixel, so smooth frames go pixel by pixel
+    if (request.mode == RenderMode::PerPixel || fractions || width < 3 || height < 3) {
+        for (int row = y; row < y + height; row++) {
+            kernel(counts, fractions, nullptr, request, x, row, width, false);
+        }
+
+        return;
+    }
+
+    Subdivider subdivider = {counts, request, kernel};
+
+    int x1 = x + width - 1;
+    int y1 = y + height - 1;
+
+    kernel(counts, nullptr, nullptr, request, x, y, width, false);
+    kernel(counts, nullptr, nullptr, request, x, y1, width, false);
+    kernel(counts, nullptr, nullptr, request, x, y + 1, height - 2, true);
+    kernel(counts, nullptr, nullptr, request, x1, y + 1, height - 2, true);
+
+    subdivider.Subdivide(x, y, x1, y1);
+}
+
+// Equalized colouring, each count looks up its level and the fraction moves it towards the level of the next count
+static void ShadeEqualizedTile(const uint32_t *counts, const float *fractions, const uint32_t *table, uint32_t iterations, const float *levels, uint8_t *pixels, int frameWidth, int x, int y, int width, int height) {
+    for (int row = y; row < y + height; row++) {
+        const uint32_t *in = counts + (size_t) row * frameWidth + x;
+        const float *fraction = fractions ? fractions + (size_t) row * frameWidth + x : nullptr;
+        uint32_t *out = (uint32_t *) pixels + (size_t) row * frameWidth + x;
+
+        for (int i = 0; i < width; i++) {
+            uint32_t count = in[i];
+
+            if (count >= iterations) {
+                out[i] = table[paletteSize];
+                continue;
+            }
+
+            float level = levels[count];
+            if (fraction) level += fraction[i] * (levels[count + 1] - level);
+
+            out[i] = table[std::min((uint32_t) level, (uint32_t) paletteSize - 1)];
+        }
+    }
+}
+
+void ShadeTile(const uint32_t *counts, const float *fractions, const RenderRequest &request, const float *levels, uint8_t *pixels, int frameWidth, int x, int y, int width, int height) {
+    const uint32_t *table = GetPaletteTable(request.palette);
+    uint32_t iterations = request.iterations;
+
+    if (levels) {
+        ShadeEqualizedTile(counts, fractions, table, iterations, levels, pixels, frameWidth, x, y, width, height);
+        return;
+    }
+
+    float scale = GetPaletteScale(request);
+
+    // Cycling palettes wrap around, the others stop at their last entry. Positions are clamped below 2^32 first
+    // so very long trips with a short cycle still convert to an index
+    uint32_t mask = request.paletteCycle > 0 ? paletteSize - 1 : ~0u;
+    const float maxPosition = 4294967040.0f;
+
+    for (int row = y; row < y + height; row++) {
+        const uint32_t *in = counts + (size_t) row * frameWidth + x;
+        const float *fraction = fractions ? fractions + (size_t) row * frameWidth + x : nullptr;
+        uint32_t *out = (uint32_t *) pixels + (size_t) row * frameWidth + x;
+
+        // No branches or calls so the compiler can vectorize the rows, the entry past the gradient is the interior
+        if (fraction) {
+            for (int i = 0; i < width; i++) {
+                uint32_t index = std::min((uint32_t) std::min(((float) in[i] + fraction[i]) * scale, maxPosition) & mask, (uint32_t) paletteSize - 1);
+                out[i] = table[in[i] >= iterations ? paletteSize : index];
+            }
+        } else {
+            for (int i = 0; i < width; i++) {
+                uint32_t index = std::min((uint32_t) std::min((float) in[i] * scale, maxPosition) & mask, (uint32_t) paletteSize - 1);
+                out[i] = table[in[i] >= iterations ? paletteSize : index];
+            }
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+#include "core/render.hpp"
+#include "core/continuation.hpp"
+#include "core/iteration-buffer.hpp"
+
+inline std::complex<double> PixelToPoint(const RenderRequest &request, int x, int y) {
+    double real = request.pivot.real() + ((x - (float) request.width / 2.0f) / request.resolution);
+    double imag = request.pivot.imag() + ((y - (float) request.height / 2.0f) / request.resolution);
+
+    return std::complex<double>(real, imag);
+}
+
+// Closed-form membership test for the main cardioid and the period-2 bulb, where every point is in the set
+inline bool InMainCardioidOrBulb(double cr, double ci) {
+    double ci2 = ci * ci;
+
+    double xr = cr - 0.25;
+    double q = xr * xr + ci2;
+    if (q * (q + xr) <= 0.25 * ci2) return true;
+
+    double br = cr + 1;
+    return br * br + ci2 <= 0.0625;
+}
+
+// Iteration step of each FractalType. Kernels are templates over these, so the fractal is picked once per span and
+// the inner loop never branches on it. Julia formulas start z at the pixel and take c from the seed, bulbs formulas
+// may skip the cardioid and period-2 bulb, and orbits escape once |z|^2 reaches bailout
+struct MandelbrotFormula {
+    static constexpr bool julia = false;
+    static constexpr bool bulbs = true;
+    static constexpr double bailout = 2;
+
+    static void Step(double &zr, double &zi, double zr2, double zi2, double cr, double ci, int power) {
+        zi = 2 * zr * zi + ci;
+        zr = zr2 - zi2 + cr;
+    }
+};
+
+struct JuliaFormula : MandelbrotFormula {
+    static constexpr bool julia = true;
+    static constexpr bool bulbs = false;
+    static constexpr double bailout = 4;
+};
+
+// A Power of 0 takes the exponent from the request, the common ones get a loop the compiler unrolls
+template <int Power>
+struct MultibrotFormula {
+    static constexpr bool julia = false;
+    static constexpr bool bulbs = false;
+    static constexpr double bailout = 4;
+
+    static void Step(double &zr, double &zi, double zr2, double zi2, double cr, double ci, int power) {
+        int exponent = Power > 0 ? Power : power;
+        double wr = zr, wi = zi;
+
+        for (int p = 1; p < exponent; p++) {
+            double t = wr * zr - wi * zi;
+            wi = wr * zi + wi * zr;
+            wr = t;
+        }
+
+        zr = wr + cr;
+        zi = wi + ci;
+    }
+};
+
+struct BurningShipFormula {
+    static constexpr bool julia = false;
+    static constexpr bool bulbs = false;
+    static constexpr double bailout = 4;
+
+    static void Step(double &zr, double &zi, double zr2, double zi2, double cr, double ci, int power) {
+        zi = 2 * std::abs(zr * zi) + ci;
+        zr = zr2 - zi2 + cr;
+    }
+};
+
+// Calls visit with the formula of request.fractal, so a generic lambda can instantiate a kernel for it
+template <typename Visitor>
+inline void VisitFormula(const RenderRequest &request, Visitor &&visit) {
+    switch (request.fractal) {
+        case FractalType::Julia: visit(JuliaFormula()); break;
+        case FractalType::BurningShip: visit(BurningShipFormula()); break;
+
+        case FractalType::Multibrot:
+            if (request.power == 3) visit(MultibrotFormula<3>());
+            else if (request.power == 4) visit(MultibrotFormula<4>());
+            else visit(MultibrotFormula<0>());
+            break;
+
+        default: visit(MandelbrotFormula()); break;
+    }
+}
+
+// Squared escape radius of Formula, smooth frames let orbits run further out
+template <typename Formula>
+inline double GetBailout(const RenderRequest &request) {
+    return request.smooth ? smoothBailout : Formula::bailout;
+}
+
+// Fraction of an iteration a smooth frame adds to the count n of a pixel whose z_n escaped with |z_n|^2 = norm,
+// 1 - log_d(log|z_n| / log R) where d is the degree of the formula
+inline float GetSmoothFraction(const RenderRequest &request, double norm) {
+    double degree = request.fractal == FractalType::Multibrot ? request.power : 2;
+    double fraction = 1 - std::log2(std::log(norm) / std::log(smoothBailout)) / std::log2(degree);
+
+    return (float) std::clamp(fraction, 0.0, 1.0);
+}
+
+// Squared distance in the complex plane under which an orbit counts as having closed a cycle
+inline double PeriodToleranceSquared(const RenderRequest &request) {
+    double tolerance = request.periodTolerance / request.resolution;
+    return tolerance * tolerance;
+}
+
+// Computes the escape counts of count pixels going right from (x, y), their smooth fractions into fractions and their
+// last z into orbits when those aren't null. Orbits are interleaved real and imaginary parts at twice the index of the
+// count, with NaN for interior points
+void CalculateMandelbrotSpan(uint32_t *counts, float *fractions, double *orbits, const RenderRequest &request, int x, int y, int count);
+
+// Carries on iterating the pixel at (cr, ci) from z, which was reached after count iterations, up to request.iterations.
+// Leaves the new count and z behind and returns whether the point escaped, closed a cycle or is still running
+PixelState ContinueMandelbrot(const RenderRequest &request, double cr, double ci, double &zr, double &zi, uint32_t &count);
+
+// Computes the escape counts of the width x height pixels at (x, y) of request, which sits at (frameX, frameY) of the
+// frame of continuation. Pixels it already knows carry on from their saved state, runs of unknown ones go through the
+// span kernels, leaving their last z in orbits, and have their state sorted into it afterwards
+void CalculateContinuedTile(uint32_t *counts, double *orbits, Continuation &continuation, const RenderRequest &request, int frameX, int frameY,
+                            int x, int y, int width, int height);
+
+// Escape count of the point (real, imag), and its smooth fraction when fraction isn't null. For samples off the pixel
+// grid, which the span kernels can't reach
+uint32_t CalculateMandelbrotPoint(const RenderRequest &request, double real, double imag, float *fraction);
+
+// Computes the escape count of every point in [from, to) of the row-major frame, and its smooth fraction when
+// fractions isn't null
+void CalculateMandelbrot(uint32_t *counts, float *fractions, const RenderRequest &request, int from, int to);
+
+// Computes the escape count of every point in the width x height block at (x, y), subdividing it
+// instead of going pixel by pixel when the request asks for RenderMode::Subdivide. Fractions is null
+// unless the request is smooth
+void CalculateMandelbrotTile(uint32_t *counts, float *fractions, const RenderRequest &request, int x, int y, int width, int height);
+
+// Colouring pass, looks the escape counts of the width x height block at (x, y), plus their fractions when those
+// aren't null, up in the palette of request and writes RGBA8 pixels. Counts are placed in the palette by the levels
+// of a HistogramEqualizer when those aren't null, and by the palette scale of request otherwise. All buffers are
+// row-major with frameWidth pixels per row, so tiles can be shaded by the thread that computed them
+void ShadeTile(const uint32_t *counts, const float *fractions, const RenderRequest &request, const float *levels, uint8_t *pixels, int frameWidth, int x, int y, int width, int height);
+
+// Whether buffer holds a frame of the size of request with everything its colouring needs, so Recolor can
+// shade it again
+inline bool CanRecolor(const IterationBuffer &buffer, const RenderRequest &request) {
+    return buffer.GetCounts() && buffer.GetWidth() == request.width && buffer.GetHeight() == request.height && request.smooth == (buffer.GetFractions() != nullptr);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// Zoom levels past which single precision, and then double-float (two floats, about 48 bits of mantissa),
+// can no longer tell neighbouring pixels apart
+const double floatPrecisionResolution = 1e5;
+const double doubleFloatPrecisionResolution = 1e12;
+
+// Splits a double into the unevaluated float sum hi + lo that the double-float kernels and shaders take
+inline void SplitDouble(double value, float &hi, float &lo) {
+    hi = (float) value;
+    lo = (float) (value - hi);
+}
@@ -0,0 +1,1145 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <filesystem>
+
+#include "core/gpu-backend.hpp"
+#include "core/cpu-kernel.hpp"
+#include "core/double-float.hpp"
+#include "core/palette.hpp"
+
+const char mandelbrotKernelSource[] = R"(
+// FRACTAL and POWER are set with -D when the program is built, one program per fractal, so the loops never
+// branch on the formula. The values follow FractalType
+#define FRACTAL_MANDELBROT 0
+#define FRACTAL_JULIA 1
+#define FRACTAL_MULTIBROT 2
+#define FRACTAL_BURNING_SHIP 3
+
+#ifndef FRACTAL
+#define FRACTAL FRACTAL_MANDELBROT
+#endif
+
+#ifndef POWER
+#define POWER 3
+#endif
+
+#if FRACTAL == FRACTAL_MULTIBROT
+#define DEGREE POWER
+#else
+#define DEGREE 2
+#endif
+
+// Fraction of an iteration a smooth frame adds to the count of a pixel that escaped with |z|^2 = norm, as on the CPU
+float smooth_fraction(float norm, float bailout) {
+    return clamp(1.0f - log2(log(norm) / log(bailout)) / log2((float) DEGREE), 0.0f, 1.0f);
+}
+
+// One iteration from z, with xx and yy its squared parts
+float2 fractal_step(float2 z, float xx, float yy, float2 c) {
+#if FRACTAL == FRACTAL_MULTIBROT
+    float2 w = z;
+    for (int p = 1; p < POWER; p++) w = (float2)(w.x * z.x - w.y * z.y, w.x * z.y + w.y * z.x);
+    return w + c;
+#elif FRACTAL == FRACTAL_BURNING_SHIP
+    return (float2)(xx - yy, 2 * fabs(z.x * z.y)) + c;
+#else
+    return (float2)(xx - yy, 2 * z.x * z.y) + c;
+#endif
+}
+
+bool in_main_cardioid_or_bulb(float2 c) {
+    float yy = c.y * c.y;
+
+    float xr = c.x - 0.25f;
+    float q = xr * xr + yy;
+    if (q * (q + xr) <= 0.25f * yy) return true;
+
+    float br = c.x + 1.0f;
+    return br * br + yy <= 0.0625f;
+}
+
+// Escape count of point, plus its fraction when smooth is set, and iterations for points that never escape. Julia sets
+// take c from seed, the other fractals from the point
+float iterate_point(float2 point, int iterations, int bulbCheck, float periodTolerance, float2 seed, float bailout, int smooth) {
+    float2 c = FRACTAL == FRACTAL_JULIA ? seed : point;
+    float2 z = FRACTAL == FRACTAL_JULIA ? point : (float2)(0.0f, 0.0f);
+
+    int iter = 0;
+
+    // Interior of the cardioid and the period-2 bulb never escapes, skip straight to the full count
+    if (FRACTAL == FRACTAL_MANDELBROT && bulbCheck && in_main_cardioid_or_bulb(c)) {
+        iter = iterations;
+    }
+
+    // Brent's cycle detection, the saved point moves up to z at every power of two iterations
+    float2 saved = z;
+    int nextSave = 1;
+    float norm = 0.0f;
+
+    for (; iter < iterations; iter++) {
+        float xx = z.x * z.x;
+        float yy = z.y * z.y;
+
+        norm = xx + yy;
+        if (norm >= bailout) break;
+
+        z = fractal_step(z, xx, yy, c);
+
+        if (periodTolerance > 0.0f) {
+            float2 d = z - saved;
+
+            if (dot(d, d) < periodTolerance * periodTolerance) {
+                iter = iterations;
+                break;
+            }
+
+            if (iter == nextSave) {
+                saved = z;
+                nextSave *= 2;
+            }
+        }
+    }
+
+    return smooth && iter < iterations ? iter + smooth_fraction(norm, bailout) : iter;
+}
+
+// Pixel (x, y) of the frame, which need not be whole
+float2 frame_point(float x, float y, int2 dimensions, float resolution, float2 pivot) {
+    return pivot + ((float2)(x, y) - (float2)(dimensions.x, dimensions.y) / 2) / resolution;
+}
+
+// field gets the value of iterate_point for every pixel
+__kernel void generate_mandelbrot(int2 dimensions, float resolution, int iterations, float2 pivot, int bulbCheck, float periodTolerance, float2 seed, float bailout, int smooth, __global float *field) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= dimensions.x || y >= dimensions.y) return;
+
+    field[y * dimensions.x + x] = iterate_point(frame_point(x, y, dimensions, resolution, pivot), iterations, bulbCheck, periodTolerance, seed, bailout, smooth);
+}
+
+// Double-float arithmetic, every value is the unevaluated sum hi + lo of two floats
+float2 df_quick_two_sum(float a, float b) {
+    float s = a + b;
+    return (float2)(s, b - (s - a));
+}
+
+float2 df_two_sum(float a, float b) {
+    float s = a + b;
+    float v = s - a;
+    return (float2)(s, (a - (s - v)) + (b - v));
+}
+
+float2 df_add(float2 a, float2 b) {
+    float2 s = df_two_sum(a.x, b.x);
+    return df_quick_two_sum(s.x, s.y + a.y + b.y);
+}
+
+float2 df_sub(float2 a, float2 b) {
+    return df_add(a, -b);
+}
+
+float2 df_mul(float2 a, float2 b) {
+    float p = a.x * b.x;
+    float e = fma(a.x, b.x, -p) + (a.x * b.y + a.y * b.x);
+    return df_quick_two_sum(p, e);
+}
+
+float2 df_abs(float2 a) {
+    return a.x < 0.0f ? -a : a;
+}
+
+// fractal_step in double-float
+void df_fractal_step(float2 *zr, float2 *zi, float2 xx, float2 yy, float2 cr, float2 ci) {
+#if FRACTAL == FRACTAL_MULTIBROT
+    float2 wr = *zr;
+    float2 wi = *zi;
+
+    for (int p = 1; p < POWER; p++) {
+        float2 t = df_sub(df_mul(wr, *zr), df_mul(wi, *zi));
+        wi = df_add(df_mul(wr, *zi), df_mul(wi, *zr));
+        wr = t;
+    }
+
+    *zr = df_add(wr, cr);
+    *zi = df_add(wi, ci);
+#else
+#if FRACTAL == FRACTAL_BURNING_SHIP
+    float2 xy = df_abs(df_mul(*zr, *zi));
+#else
+    float2 xy = df_mul(*zr, *zi);
+#endif
+
+    *zr = df_add(df_sub(xx, yy), cr);
+    *zi = df_add(df_add(xy, xy), ci);
+#endif
+}
+
+// in_main_cardioid_or_bulb in double-float, rounding c to float would move the boundary by more than a pixel at the
+// zooms these kernels run at
+bool in_main_cardioid_or_bulb_df(float2 cr, float2 ci) {
+    float2 yy = df_mul(ci, ci);
+
+    float2 xr = df_add(cr, (float2)(-0.25f, 0.0f));
+    float2 q = df_add(df_mul(xr, xr), yy);
+    if (df_sub(df_mul(q, df_add(q, xr)), 0.25f * yy).x <= 0.0f) return true;
+
+    float2 br = df_add(cr, (float2)(1.0f, 0.0f));
+    return df_add(df_add(df_mul(br, br), yy), (float2)(-0.0625f, 0.0f)).x <= 0.0f;
+}
+
+// Same as iterate_point, with the point (re.hi, re.lo, im.hi, im.lo) and seed in double-float
+float iterate_point_df(float4 point, int iterations, int bulbCheck, float periodTolerance, float4 seed, float bailout, int smooth) {
+    float2 pointR = point.xy;
+    float2 pointI = point.zw;
+
+    float2 cr = FRACTAL == FRACTAL_JULIA ? seed.xy : pointR;
+    float2 ci = FRACTAL == FRACTAL_JULIA ? seed.zw : pointI;
+    float2 zr = FRACTAL == FRACTAL_JULIA ? pointR : (float2)(0.0f, 0.0f);
+    float2 zi = FRACTAL == FRACTAL_JULIA ? pointI : (float2)(0.0f, 0.0f);
+
+    int iter = 0;
+
+    if (FRACTAL == FRACTAL_MANDELBROT && bulbCheck && in_main_cardioid_or_bulb_df(cr, ci)) {
+        iter = iterations;
+    }
+
+    float2 savedR = zr;
+    float2 savedI = zi;
+    int nextSave = 1;
+    float norm = 0.0f;
+
+    for (; iter < iterations; iter++) {
+        float2 xx = df_mul(zr, zr);
+        float2 yy = df_mul(zi, zi);
+
+        norm = xx.x + yy.x;
+        if (norm >= bailout) break;
+
+        df_fractal_step(&zr, &zi, xx, yy, cr, ci);
+
+        if (periodTolerance > 0.0f) {
+            float dr = df_sub(zr, savedR).x;
+            float di = df_sub(zi, savedI).x;
+
+            if (dr * dr + di * di < periodTolerance * periodTolerance) {
+                iter = iterations;
+                break;
+            }
+
+            if (iter == nextSave) {
+                savedR = zr;
+                savedI = zi;
+                nextSave *= 2;
+            }
+        }
+    }
+
+    return smooth && iter < iterations ? iter + smooth_fraction(norm, bailout) : iter;
+}
+
+float4 frame_point_df(float x, float y, int2 dimensions, float2 pixelSize, float4 pivot) {
+    float2 pointR = df_add(pivot.xy, df_mul((float2)(x - dimensions.x / 2.0f, 0.0f), pixelSize));
+    float2 pointI = df_add(pivot.zw, df_mul((float2)(y - dimensions.y / 2.0f, 0.0f), pixelSize));
+
+    return (float4)(pointR, pointI);
+}
+
+// Same as generate_mandelbrot, with the pivot and seed (re.hi, re.lo, im.hi, im.lo) and pixel size in double-float
+__kernel void generate_mandelbrot_df(int2 dimensions, float2 pixelSize, int iterations, float4 pivot, int bulbCheck, float periodTolerance, float4 seed, float bailout, int smooth, __global float *field) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= dimensions.x || y >= dimensions.y) return;
+
+    field[y * dimensions.x + x] = iterate_point_df(frame_point_df(x, y, dimensions, pixelSize, pivot), iterations, bulbCheck, periodTolerance, seed, bailout, smooth);
+}
+
+// Jittered offset of sample k of a pixel, the same sequence as GetSampleOffset on the CPU
+float2 sample_offset(uint pixel, int sample) {
+    uint hash = pixel * 0x9E3779B9u;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    hash *= 0x846CA68Bu;
+    hash ^= hash >> 16;
+
+    float2 point = (float2)(hash & 0xFFFF, hash >> 16) / 65536.0f + (float2)(0.7548776662f, 0.5698402910f) * (sample + 1);
+    return point - floor(point) - 0.5f;
+}
+
+bool is_edge(int count, int other, int iterations, int threshold) {
+    return (count >= iterations) != (other >= iterations) || abs(count - other) > threshold;
+}
+
+// Compacts the pixels whose count differs from one of their four neighbours by more than threshold, or that border the
+// interior, into edges, in no particular order
+__kernel void find_edges(int2 dimensions, __global const float *field, int iterations, int threshold, __global int *edgeCount, __global int *edges) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= dimensions.x || y >= dimensions.y) return;
+
+    int i = y * dimensions.x + x;
+    int count = (int) field[i];
+
+    bool edge = (x > 0 && is_edge(count, (int) field[i - 1], iterations, threshold)) || (x + 1 < dimensions.x && is_edge(count, (int) field[i + 1], iterations, threshold)) ||
+                (y > 0 && is_edge(count, (int) field[i - dimensions.x], iterations, threshold)) || (y + 1 < dimensions.y && is_edge(count, (int) field[i + dimensions.x], iterations, threshold));
+
+    if (edge) edges[atomic_inc(edgeCount)] = i;
+}
+
+// One work item per sample, samples[e * sampleCount + k] gets the value of sample k of edge e. The first nine arguments
+// are the ones of generate_mandelbrot
+__kernel void sample_edges(int2 dimensions, float resolution, int iterations, float2 pivot, int bulbCheck, float periodTolerance, float2 seed, float bailout, int smooth,
+                           int edgeCount, __global const int *edges, int sampleCount, __global float *samples) {
+    int id = get_global_id(0);
+    if (id >= edgeCount * sampleCount) return;
+
+    int pixel = edges[id / sampleCount];
+    float2 offset = sample_offset(pixel, id % sampleCount);
+    float2 point = frame_point(pixel % dimensions.x + offset.x, pixel / dimensions.x + offset.y, dimensions, resolution, pivot);
+
+    samples[id] = iterate_point(point, iterations, bulbCheck, periodTolerance, seed, bailout, smooth);
+}
+
+__kernel void sample_edges_df(int2 dimensions, float2 pixelSize, int iterations, float4 pivot, int bulbCheck, float periodTolerance, float4 seed, float bailout, int smooth,
+                              int edgeCount, __global const int *edges, int sampleCount, __global float *samples) {
+    int id = get_global_id(0);
+    if (id >= edgeCount * sampleCount) return;
+
+    int pixel = edges[id / sampleCount];
+    float2 offset = sample_offset(pixel, id % sampleCount);
+    float4 point = frame_point_df(pixel % dimensions.x + offset.x, pixel / dimensions.x + offset.y, dimensions, pixelSize, pivot);
+
+    samples[id] = iterate_point_df(point, iterations, bulbCheck, periodTolerance, seed, bailout, smooth);
+}
+
+// Lowest and highest escaped count of the field, reduced in local memory so every workgroup touches range once.
+// The two equalization kernels run on a grid rounded up to whole workgroups, since they meet at barriers
+__kernel void field_range(int2 dimensions, __global const float *field, int iterations, __global int *range) {
+    __local int low;
+    __local int high;
+
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    bool first = get_local_id(0) == 0 && get_local_id(1) == 0;
+
+    if (first) {
+        low = iterations;
+        high = -1;
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (x < dimensions.x && y < dimensions.y) {
+        int count = (int) field[y * dimensions.x + x];
+
+        if (count < iterations) {
+            atomic_min(&low, count);
+            atomic_max(&high, count);
+        }
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (first && high >= 0) {
+        atomic_min(&range[0], low);
+        atomic_max(&range[1], high);
+    }
+}
+
+#define LOCAL_BINS 1024
+
+// Histogram of the escaped counts from low on. Every workgroup counts the first LOCAL_BINS bins in local memory and
+// adds them to histogram once, higher counts are rarer and go to histogram directly
+__kernel void histogram_field(int2 dimensions, __global const float *field, int iterations, int low, int bins, __global uint *histogram) {
+    __local uint groupHistogram[LOCAL_BINS];
+
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    int lane = get_local_id(1) * get_local_size(0) + get_local_id(0);
+    int lanes = get_local_size(0) * get_local_size(1);
+
+    for (int bin = lane; bin < LOCAL_BINS; bin += lanes) groupHistogram[bin] = 0;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (x < dimensions.x && y < dimensions.y) {
+        int count = (int) field[y * dimensions.x + x];
+        int bin = count - low;
+
+        if (count < iterations) {
+            if (bin < LOCAL_BINS) atomic_inc(&groupHistogram[bin]);
+            else atomic_inc(&histogram[bin]);
+        }
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int bin = lane; bin < min(bins, LOCAL_BINS); bin += lanes) {
+        if (groupHistogram[bin] != 0) atomic_add(&histogram[bin], groupHistogram[bin]);
+    }
+}
+
+// The same lookup as ShadeTile on the CPU. palette has paletteSize entries of RGBA8 followed by the colour of the
+// interior, and mask wraps cycling palettes around. Equalized frames are placed by levels instead, the palette
+// position of the bins counts from low on, and counts outside them go to either end of the palette
+uint palette_entry(float value, int iterations, float scale, uint mask, int paletteSize, int equalize, int low, int bins, __global const float *levels) {
+    if (value >= iterations) return paletteSize;
+    if (!equalize) return min((uint) min(value * scale, 4294967040.0f) & mask, (uint) paletteSize - 1);
+
+    int bin = (int) value - low;
+    if (bin < 0) return 0;
+    if (bin >= bins) return paletteSize - 1;
+
+    float level = levels[bin] + (value - floor(value)) * (levels[bin + 1] - levels[bin]);
+    return min((uint) level, (uint) paletteSize - 1);
+}
+
+// Colouring pass
+__kernel void color_field(int2 dimensions, __global const float *field, int iterations, float scale, uint mask, int paletteSize, __global const uint *palette,
+                          int equalize, int low, int bins, __global const float *levels, __global uchar4 *out) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+
+    if (x >= dimensions.x || y >= dimensions.y) return;
+
+    float value = field[y * dimensions.x + x];
+    out[y * dimensions.x + x] = as_uchar4(palette[palette_entry(value, iterations, scale, mask, paletteSize, equalize, low, bins, levels)]);
+}
+
+// Averages the colour color_field gave every edge with the colours of its samples. The arguments after the samples
+// are the ones of color_field
+__kernel void resolve_edges(int edgeCount, __global const int *edges, int sampleCount, __global const float *samples, int iterations, float scale, uint mask, int paletteSize,
+                            __global const uint *palette, int equalize, int low, int bins, __global const float *levels, __global uchar4 *out) {
+    int e = get_global_id(0);
+    if (e >= edgeCount) return;
+
+    int pixel = edges[e];
+    uint4 sum = convert_uint4(out[pixel]);
+
+    for (int k = 0; k < sampleCount; k++) {
+        float value = samples[e * sampleCount + k];
+        sum += convert_uint4(as_uchar4(palette[palette_entry(value, iterations, scale, mask, paletteSize, equalize, low, bins, levels)]));
+    }
+
+    out[pixel] = convert_uchar4((sum + (uint) (sampleCount + 1) / 2) / (uint) (sampleCount + 1));
+}
+)";
+
+GpuBackend::GpuBackend(const GpuOptions &options) : options(options) {
+
+}
+
+GpuBackend::~GpuBackend() {
+    Release();
+}
+
+void GpuBackend::Release() {
+    if (buffer) clReleaseMemObject(buffer);
+    if (fieldBuffer) clReleaseMemObject(fieldBuffer);
+    if (paletteBuffer) clReleaseMemObject(paletteBuffer);
+    if (rangeBuffer) clReleaseMemObject(rangeBuffer);
+    if (histogramBuffer) clReleaseMemObject(histogramBuffer);
+    if (levelsBuffer) clReleaseMemObject(levelsBuffer);
+    if (edgeCountBuffer) clReleaseMemObject(edgeCountBuffer);
+    if (edgesBuffer) clReleaseMemObject(edgesBuffer);
+    if (samplesBuffer) clReleaseMemObject(samplesBuffer);
+
+    for (auto &entry : programs) {
+        Program &built = entry.second;
+
+        if (built.floatKernel) clReleaseKernel(built.floatKernel);
+        if (built.doubleFloatKernel) clReleaseKernel(built.doubleFloatKernel);
+        if (built.colorKernel) clReleaseKernel(built.colorKernel);
+        if (built.rangeKernel) clReleaseKernel(built.rangeKernel);
+        if (built.histogramKernel) clReleaseKernel(built.histogramKernel);
+        if (built.edgeKernel) clReleaseKernel(built.edgeKernel);
+        if (built.sampleKernel) clReleaseKernel(built.sampleKernel);
+        if (built.sampleDfKernel) clReleaseKernel(built.sampleDfKernel);
+        if (built.resolveKernel) clReleaseKernel(built.resolveKernel);
+        if (built.program) clReleaseProgram(built.program);
+    }
+
+    if (commandQueue) clReleaseCommandQueue(commandQueue);
+    if (context) clReleaseContext(context);
+
+    buffer = nullptr;
+    fieldBuffer = nullptr;
+    paletteBuffer = nullptr;
+    paletteUploaded = false;
+    rangeBuffer = nullptr;
+    histogramBuffer = nullptr;
+    levelsBuffer = nullptr;
+    histogramCapacity = 0;
+    edgeCountBuffer = nullptr;
+    edgesBuffer = nullptr;
+    samplesBuffer = nullptr;
+    edgesCapacity = 0;
+    samplesCapacity = 0;
+    edgeCount = 0;
+    hasField = false;
+    programs.clear();
+    commandQueue = nullptr;
+    context = nullptr;
+    device = nullptr;
+    bufferSize = 0;
+}
+
+static std::string GetDeviceString(cl_device_id device, cl_device_info info) {
+    size_t size = 0;
+    if (clGetDeviceInfo(device, info, 0, nullptr, &size) != CL_SUCCESS) return "";
+
+    std::string value(size, '\0');
+    clGetDeviceInfo(device, info, size, value.data(), nullptr);
+
+    return value;
+}
+
+// 64-bit FNV-1a, only used to name cache files
+static uint64_t HashString(const std::string &text, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+std::string GpuBackend::GetCachePath(const std::string &buildOptions) const {
+    // A driver update can change the binary format, so its version is part of the key
+    uint64_t hash = HashString(GetDeviceString(device, CL_DEVICE_NAME));
+    hash = HashString(GetDeviceString(device, CL_DEVICE_VENDOR), hash);
+    hash = HashString(GetDeviceString(device, CL_DRIVER_VERSION), hash);
+    hash = HashString(mandelbrotKernelSource, hash);
+    hash = HashString(buildOptions, hash);
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+
+    return (std::filesystem::path(options.cacheDirectory) / name.str()).string();
+}
+
+bool GpuBackend::BuildProgram(const std::string &buildOptions, Program &built) {
+    cl_int clError;
+    std::string cachePath = options.cacheDirectory.empty() ? "" : GetCachePath(buildOptions);
+    cl_program &program = built.program;
+
+    programCached = false;
+
+    if (!cachePath.empty()) {
+        std::ifstream file(cachePath, std::ios::binary);
+        std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (!binary.empty()) {
+            const unsigned char *data = binary.data();
+            size_t size = binary.size();
+            cl_int binaryStatus;
+
+            program = clCreateProgramWithBinary(context, 1, &device, &size, &data, &binaryStatus, &clError);
+
+            if (clError == CL_SUCCESS && binaryStatus == CL_SUCCESS) {
+                clError = clBuildProgram(program, 1, &device, buildOptions.c_str(), nullptr, nullptr);
+                if (clError == CL_SUCCESS) {
+                    programCached = true;
+                    return true;
+                }
+            }
+
+            // Stale or foreign binary, fall back to the source and overwrite it
+            if (program) clReleaseProgram(program);
+            program = nullptr;
+        }
+    }
+
+    const char *source = mandelbrotKernelSource;
+    size_t sourceLength = sizeof(mandelbrotKernelSource);
+
+    program = clCreateProgramWithSource(context, 1, &source, &sourceLength, &clError);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to create program!\n";
+        program = nullptr;
+        return false;
+    }
+
+    clError = clBuildProgram(program, 1, &device, buildOptions.c_str(), nullptr, nullptr);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to build program!\n";
+
+        size_t len;
+        char buffer[2048];
+
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+
+        std::cout << buffer << "\n";
+        return false;
+    }
+
+    if (cachePath.empty()) return true;
+
+    size_t binarySize = 0;
+    clError = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &binarySize, nullptr);
+    if (clError != CL_SUCCESS || binarySize == 0) return true;
+
+    std::vector<unsigned char> binary(binarySize);
+    unsigned char *data = binary.data();
+
+    clError = clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char *), &data, nullptr);
+    if (clError != CL_SUCCESS) return true;
+
+    // The cache is only an optimization, failing to write it is not an error
+    std::error_code ignored;
+    std::filesystem::create_directories(options.cacheDirectory, ignored);
+
+    std::ofstream file(cachePath, std::ios::binary);
+    file.write((const char *) binary.data(), binary.size());
+
+    return true;
+}
+
+bool GpuBackend::Initialize() {
+    cl_int clError;
+    cl_uint platformCount;
+    cl_platform_id *platforms;
+    cl_device_type deviceType = CL_DEVICE_TYPE_DEFAULT;
+
+    if (options.deviceType == GpuDeviceType::Gpu) deviceType = CL_DEVICE_TYPE_GPU;
+    if (options.deviceType == GpuDeviceType::Cpu) deviceType = CL_DEVICE_TYPE_CPU;
+
+    clError = clGetPlatformIDs(0, nullptr, &platformCount);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to count platforms!\n";
+        return false;
+    }
+
+    platforms = new cl_platform_id[platformCount];
+    clError = clGetPlatformIDs(platformCount, platforms, &platformCount);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to query platforms!\n";
+        delete[] platforms;
+        return false;
+    }
+
+    for (cl_uint i = 0; i < platformCount; i++) {
+        clError = clGetDeviceIDs(platforms[i], deviceType, 1, &device, nullptr);
+        if (clError == CL_SUCCESS) break;
+    }
+
+    delete[] platforms;
+
+    if (device == NULL) {
+        std::cout << "An error occured when trying to obtain OpenCL device!\n";
+        return false;
+    }
+
+    context = clCreateContext(0, 1, &device, nullptr, nullptr, &clError);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to create context!\n";
+        context = nullptr;
+        Release();
+        return false;
+    }
+
+    commandQueue = clCreateCommandQueue(context, device, 0, &clError);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to create command queue!\n";
+        commandQueue = nullptr;
+        Release();
+        return false;
+    }
+
+    return true;
+}
+
+// -D options of the program for request, the formula is fixed when the kernel is compiled
+static std::string GetBuildOptions(const RenderRequest &request) {
+    std::ostringstream buildOptions;
+    buildOptions << "-D FRACTAL=" << (int) request.fractal;
+
+    if (request.fractal == FractalType::Multibrot) buildOptions << " -D POWER=" << request.power;
+
+    return buildOptions.str();
+}
+
+GpuBackend::Program *GpuBackend::GetProgram(const RenderRequest &request) {
+    std::string buildOptions = GetBuildOptions(request);
+
+    auto found = programs.find(buildOptions);
+    if (found != programs.end()) return &found->second;
+
+    Program built;
+    cl_int clError;
+
+    if (!BuildProgram(buildOptions, built)) {
+        if (built.program) clReleaseProgram(built.program);
+        return nullptr;
+    }
+
+    built.floatKernel = clCreateKernel(built.program, "generate_mandelbrot", &clError);
+    if (clError == CL_SUCCESS) built.doubleFloatKernel = clCreateKernel(built.program, "generate_mandelbrot_df", &clError);
+    if (clError == CL_SUCCESS) built.colorKernel = clCreateKernel(built.program, "color_field", &clError);
+    if (clError == CL_SUCCESS) built.rangeKernel = clCreateKernel(built.program, "field_range", &clError);
+    if (clError == CL_SUCCESS) built.histogramKernel = clCreateKernel(built.program, "histogram_field", &clError);
+    if (clError == CL_SUCCESS) built.edgeKernel = clCreateKernel(built.program, "find_edges", &clError);
+    if (clError == CL_SUCCESS) built.sampleKernel = clCreateKernel(built.program, "sample_edges", &clError);
+    if (clError == CL_SUCCESS) built.sampleDfKernel = clCreateKernel(built.program, "sample_edges_df", &clError);
+    if (clError == CL_SUCCESS) built.resolveKernel = clCreateKernel(built.program, "resolve_edges", &clError);
+
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to create kernel!\n";
+
+        if (built.floatKernel) clReleaseKernel(built.floatKernel);
+        if (built.doubleFloatKernel) clReleaseKernel(built.doubleFloatKernel);
+        if (built.colorKernel) clReleaseKernel(built.colorKernel);
+        if (built.rangeKernel) clReleaseKernel(built.rangeKernel);
+        if (built.histogramKernel) clReleaseKernel(built.histogramKernel);
+        if (built.edgeKernel) clReleaseKernel(built.edgeKernel);
+        if (built.sampleKernel) clReleaseKernel(built.sampleKernel);
+        if (built.sampleDfKernel) clReleaseKernel(built.sampleDfKernel);
+        clReleaseProgram(built.program);
+        return nullptr;
+    }
+
+    return &(programs[buildOptions] = built);
+}
+
+bool GpuBackend::ReserveBuffers(int width, int height) {
+    size_t size = (size_t) width * height * sizeof(cl_uchar4);
+
+    if (size <= bufferSize) return true;
+
+    if (buffer) clReleaseMemObject(buffer);
+    if (fieldBuffer) clReleaseMemObject(fieldBuffer);
+    bufferSize = 0;
+    hasField = false;
+
+    cl_int clError;
+    buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, size, nullptr, &clError);
+    if (clError == CL_SUCCESS) fieldBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, (size_t) width * height * sizeof(cl_float), nullptr, &clError);
+
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to create buffer!\n";
+        if (buffer) clReleaseMemObject(buffer);
+        buffer = nullptr;
+        fieldBuffer = nullptr;
+        return false;
+    }
+
+    pixels.reset(new uint8_t[size]);
+    bufferSize = size;
+
+    return true;
+}
+
+bool GpuBackend::Render(const RenderRequest &request, sf::Image &image) {
+    int width = request.width;
+    int height = request.height;
+    int dimensions[2] = {width, height};
+    size_t szDimensions[2] = {(size_t) width, (size_t) height};
+    float resolution = request.resolution;
+    int iterations = request.iterations;
+    float pivot[2] = {(float) request.pivot.real(), (float) request.pivot.imag()};
+
+    // Past single precision the double-float kernel takes over, at a fraction of the cost of fp64
+    bool doubleFloat = request.resolution > floatPrecisionResolution;
+
+    float pixelSize[2];
+    float pivotDf[4];
+    SplitDouble(1.0 / request.resolution, pixelSize[0], pixelSize[1]);
+    SplitDouble(request.pivot.real(), pivotDf[0], pivotDf[1]);
+    SplitDouble(request.pivot.imag(), pivotDf[2], pivotDf[3]);
+    int bulbCheck = request.bulbCheck;
+    float periodTolerance = request.periodTolerance / request.resolution;
+
+    float seed[2] = {(float) request.juliaSeed.real(), (float) request.juliaSeed.imag()};
+    float seedDf[4];
+    SplitDouble(request.juliaSeed.real(), seedDf[0], seedDf[1]);
+    SplitDouble(request.juliaSeed.imag(), seedDf[2], seedDf[3]);
+
+    float bailout = 0;
+    int smooth = request.smooth;
+
+    VisitFormula(request, [&](auto formula) {
+        bailout = GetBailout<decltype(formula)>(request);
+    });
+
+    if (context == nullptr && !Initialize()) return false;
+    if (!ReserveBuffers(width, height)) return false;
+
+    Program *program = GetProgram(request);
+    if (program == nullptr) return false;
+
+    // The generating and sampling kernels share their first nine arguments
+    auto setFrameArguments = [&](cl_kernel kernel) {
+        cl_int clError = clSetKernelArg(kernel, 0, sizeof(cl_int2), dimensions);
+
+        if (doubleFloat) {
+            clError |= clSetKernelArg(kernel, 1, sizeof(cl_float2), pixelSize);
+            clError |= clSetKernelArg(kernel, 3, sizeof(cl_float4), pivotDf);
+            clError |= clSetKernelArg(kernel, 6, sizeof(cl_float4), seedDf);
+        } else {
+            clError |= clSetKernelArg(kernel, 1, sizeof(cl_float), &resolution);
+            clError |= clSetKernelArg(kernel, 3, sizeof(cl_float2), pivot);
+            clError |= clSetKernelArg(kernel, 6, sizeof(cl_float2), seed);
+        }
+
+        clError |= clSetKernelArg(kernel, 2, sizeof(cl_int), &iterations);
+        clError |= clSetKernelArg(kernel, 4, sizeof(cl_int), &bulbCheck);
+        clError |= clSetKernelArg(kernel, 5, sizeof(cl_float), &periodTolerance);
+        clError |= clSetKernelArg(kernel, 7, sizeof(cl_float), &bailout);
+        clError |= clSetKernelArg(kernel, 8, sizeof(cl_int), &smooth);
+
+        return clError;
+    };
+
+    cl_int clError;
+    cl_kernel kernel = doubleFloat ? program->doubleFloatKernel : program->floatKernel;
+
+    clError = setFrameArguments(kernel);
+    clError |= clSetKernelArg(kernel, 9, sizeof(cl_mem), &fieldBuffer);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to set kernel arguments!\n";
+        return false;
+    }
+
+    hasField = false;
+
+    clError = clEnqueueNDRangeKernel(commandQueue, kernel, 2, nullptr, szDimensions, nullptr, 0, nullptr, nullptr);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to enqueue work!\n";
+        return false;
+    }
+
+    edgeCount = 0;
+
+    if (request.antialias > 0) {
+        cl_kernel sampleKernel = doubleFloat ? program->sampleDfKernel : program->sampleKernel;
+
+        if (!FindEdges(request, *program)) return false;
+
+        if (setFrameArguments(sampleKernel) != CL_SUCCESS || !SampleEdges(request, sampleKernel)) {
+            std::cout << "An error occured when trying to sample the edges!\n";
+            return false;
+        }
+    }
+
+    fieldRequest = request;
+    hasField = true;
+
+    // The in-order queue runs the colouring kernel once the field is complete
+    return ShadeField(request, *program, image);
+}
+
+bool GpuBackend::Recolor(const RenderRequest &request, sf::Image &image) {
+    if (!hasField || request.width != fieldRequest.width || request.height != fieldRequest.height || request.iterations != fieldRequest.iterations ||
+        request.smooth != fieldRequest.smooth || !CanResolveEdges(request)) return false;
+
+    Program *program = GetProgram(request);
+    if (program == nullptr) return false;
+
+    return ShadeField(request, *program, image);
+}
+
+bool GpuBackend::ShadeField(const RenderRequest &request, Program &program, sf::Image &image) {
+    int width = request.width;
+    int height = request.height;
+    int dimensions[2] = {width, height};
+    size_t szDimensions[2] = {(size_t) width, (size_t) height};
+    int iterations = request.iterations;
+    float scale = GetPaletteScale(request);
+    cl_uint mask = request.paletteCycle > 0 ? paletteSize - 1 : ~0u;
+    int size = paletteSize;
+
+    cl_int clError;
+
+    if (paletteBuffer == nullptr) {
+        paletteBuffer = clCreateBuffer(context, CL_MEM_READ_ONLY, (paletteSize + 1) * sizeof(cl_uint), nullptr, &clError);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create palette buffer!\n";
+            paletteBuffer = nullptr;
+            return false;
+        }
+    }
+
+    if (!paletteUploaded || uploadedPalette != request.palette) {
+        clError = clEnqueueWriteBuffer(commandQueue, paletteBuffer, CL_FALSE, 0, (paletteSize + 1) * sizeof(cl_uint), GetPaletteTable(request.palette), 0, nullptr, nullptr);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to upload palette!\n";
+            return false;
+        }
+
+        uploadedPalette = request.palette;
+        paletteUploaded = true;
+    }
+
+    int equalize = request.equalize;
+    int low = 0;
+    int bins = 0;
+
+    if (equalize && !EqualizeField(request, program, low, bins)) return false;
+
+    cl_kernel kernel = program.colorKernel;
+
+    clError = clSetKernelArg(kernel, 0, sizeof(cl_int2), dimensions);
+    clError |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &fieldBuffer);
+    clError |= clSetKernelArg(kernel, 2, sizeof(cl_int), &iterations);
+    clError |= clSetKernelArg(kernel, 3, sizeof(cl_float), &scale);
+    clError |= clSetKernelArg(kernel, 4, sizeof(cl_uint), &mask);
+    clError |= clSetKernelArg(kernel, 5, sizeof(cl_int), &size);
+    clError |= clSetKernelArg(kernel, 6, sizeof(cl_mem), &paletteBuffer);
+    clError |= clSetKernelArg(kernel, 7, sizeof(cl_int), &equalize);
+    clError |= clSetKernelArg(kernel, 8, sizeof(cl_int), &low);
+    clError |= clSetKernelArg(kernel, 9, sizeof(cl_int), &bins);
+    clError |= clSetKernelArg(kernel, 10, sizeof(cl_mem), &levelsBuffer);
+    clError |= clSetKernelArg(kernel, 11, sizeof(cl_mem), &buffer);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to set kernel arguments!\n";
+        return false;
+    }
+
+    clError = clEnqueueNDRangeKernel(commandQueue, kernel, 2, nullptr, szDimensions, nullptr, 0, nullptr, nullptr);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to enqueue work!\n";
+        return false;
+    }
+
+    // Blends the kept samples into the colours color_field just wrote
+    if (request.antialias > 0 && edgeCount > 0) {
+        int sampleCount = request.antialias;
+        size_t szEdges = edgeCount;
+        kernel = program.resolveKernel;
+
+        clError = clSetKernelArg(kernel, 0, sizeof(cl_int), &edgeCount);
+        clError |= clSetKernelArg(kernel, 1, sizeof(cl_mem), &edgesBuffer);
+        clError |= clSetKernelArg(kernel, 2, sizeof(cl_int), &sampleCount);
+        clError |= clSetKernelArg(kernel, 3, sizeof(cl_mem), &samplesBuffer);
+        clError |= clSetKernelArg(kernel, 4, sizeof(cl_int), &iterations);
+        clError |= clSetKernelArg(kernel, 5, sizeof(cl_float), &scale);
+        clError |= clSetKernelArg(kernel, 6, sizeof(cl_uint), &mask);
+        clError |= clSetKernelArg(kernel, 7, sizeof(cl_int), &size);
+        clError |= clSetKernelArg(kernel, 8, sizeof(cl_mem), &paletteBuffer);
+        clError |= clSetKernelArg(kernel, 9, sizeof(cl_int), &equalize);
+        clError |= clSetKernelArg(kernel, 10, sizeof(cl_int), &low);
+        clError |= clSetKernelArg(kernel, 11, sizeof(cl_int), &bins);
+        clError |= clSetKernelArg(kernel, 12, sizeof(cl_mem), &levelsBuffer);
+        clError |= clSetKernelArg(kernel, 13, sizeof(cl_mem), &buffer);
+
+        if (clError == CL_SUCCESS) clError = clEnqueueNDRangeKernel(commandQueue, kernel, 1, nullptr, &szEdges, nullptr, 0, nullptr, nullptr);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to resolve the edge samples!\n";
+            return false;
+        }
+    }
+
+    clError = clEnqueueReadBuffer(commandQueue, buffer, CL_TRUE, 0, sizeof(uint8_t) * width * height * 4, pixels.get(), 0, nullptr, nullptr);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to enqueue read!\n";
+        return false;
+    }
+
+    image = sf::Image(sf::Vector2u(width, height), pixels.get());
+
+    return true;
+}
+
+// Workgroup edge of the equalization kernels, which need whole workgroups for their local reductions
+const size_t equalizeGroupSize = 16;
+
+bool GpuBackend::EqualizeField(const RenderRequest &request, Program &program, int &low, int &bins) {
+    int dimensions[2] = {request.width, request.height};
+    size_t szLocal[2] = {equalizeGroupSize, equalizeGroupSize};
+    size_t szGlobal[2] = {
+        (request.width + equalizeGroupSize - 1) / equalizeGroupSize * equalizeGroupSize,
+        (request.height + equalizeGroupSize - 1) / equalizeGroupSize * equalizeGroupSize
+    };
+    int iterations = request.iterations;
+
+    cl_int clError = CL_SUCCESS;
+
+    if (rangeBuffer == nullptr) {
+        rangeBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, 2 * sizeof(cl_int), nullptr, &clError);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create histogram buffer!\n";
+            rangeBuffer = nullptr;
+            return false;
+        }
+    }
+
+    int range[2] = {iterations, -1};
+
+    clError = clEnqueueWriteBuffer(commandQueue, rangeBuffer, CL_TRUE, 0, sizeof(range), range, 0, nullptr, nullptr);
+
+    clError |= clSetKernelArg(program.rangeKernel, 0, sizeof(cl_int2), dimensions);
+    clError |= clSetKernelArg(program.rangeKernel, 1, sizeof(cl_mem), &fieldBuffer);
+    clError |= clSetKernelArg(program.rangeKernel, 2, sizeof(cl_int), &iterations);
+    clError |= clSetKernelArg(program.rangeKernel, 3, sizeof(cl_mem), &rangeBuffer);
+
+    if (clError == CL_SUCCESS) clError = clEnqueueNDRangeKernel(commandQueue, program.rangeKernel, 2, nullptr, szGlobal, szLocal, 0, nullptr, nullptr);
+    if (clError == CL_SUCCESS) clError = clEnqueueReadBuffer(commandQueue, rangeBuffer, CL_TRUE, 0, sizeof(range), range, 0, nullptr, nullptr);
+
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to find the range of the field!\n";
+        return false;
+    }
+
+    // Nothing escaped, the colouring kernel never reads the levels
+    if (range[1] < 0) return true;
+
+    low = range[0];
+    bins = range[1] - range[0] + 1;
+
+    if ((size_t) bins > histogramCapacity) {
+        if (histogramBuffer) clReleaseMemObject(histogramBuffer);
+        if (levelsBuffer) clReleaseMemObject(levelsBuffer);
+        levelsBuffer = nullptr;
+        histogramCapacity = 0;
+
+        histogramBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, bins * sizeof(cl_uint), nullptr, &clError);
+        if (clError == CL_SUCCESS) levelsBuffer = clCreateBuffer(context, CL_MEM_READ_ONLY, (bins + 1) * sizeof(cl_float), nullptr, &clError);
+
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create histogram buffer!\n";
+            if (histogramBuffer) clReleaseMemObject(histogramBuffer);
+            histogramBuffer = nullptr;
+            levelsBuffer = nullptr;
+            return false;
+        }
+
+        histogramCapacity = bins;
+    }
+
+    cl_uint zero = 0;
+
+    clError = clEnqueueFillBuffer(commandQueue, histogramBuffer, &zero, sizeof(zero), 0, bins * sizeof(cl_uint), 0, nullptr, nullptr);
+
+    clError |= clSetKernelArg(program.histogramKernel, 0, sizeof(cl_int2), dimensions);
+    clError |= clSetKernelArg(program.histogramKernel, 1, sizeof(cl_mem), &fieldBuffer);
+    clError |= clSetKernelArg(program.histogramKernel, 2, sizeof(cl_int), &iterations);
+    clError |= clSetKernelArg(program.histogramKernel, 3, sizeof(cl_int), &low);
+    clError |= clSetKernelArg(program.histogramKernel, 4, sizeof(cl_int), &bins);
+    clError |= clSetKernelArg(program.histogramKernel, 5, sizeof(cl_mem), &histogramBuffer);
+
+    histogram.resize(bins);
+
+    if (clError == CL_SUCCESS) clError = clEnqueueNDRangeKernel(commandQueue, program.histogramKernel, 2, nullptr, szGlobal, szLocal, 0, nullptr, nullptr);
+    if (clError == CL_SUCCESS) clError = clEnqueueReadBuffer(commandQueue, histogramBuffer, CL_TRUE, 0, bins * sizeof(cl_uint), histogram.data(), 0, nullptr, nullptr);
+
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to build the histogram of the field!\n";
+        return false;
+    }
+
+    // The running sum is over the counts, not the pixels, so it stays on the host
+    uint64_t escaped = 0;
+    for (cl_uint binCount : histogram) escaped += binCount;
+
+    double scale = (double) paletteSize / (double) escaped;
+    uint64_t below = 0;
+    levels.resize(bins + 1);
+
+    for (int bin = 0; bin < bins; bin++) {
+        levels[bin] = (float) (below * scale);
+        below += histogram[bin];
+    }
+
+    levels[bins] = (float) paletteSize;
+
+    clError = clEnqueueWriteBuffer(commandQueue, levelsBuffer, CL_FALSE, 0, (bins + 1) * sizeof(cl_float), levels.data(), 0, nullptr, nullptr);
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to upload the levels!\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool GpuBackend::FindEdges(const RenderRequest &request, Program &program) {
+    int dimensions[2] = {request.width, request.height};
+    size_t szDimensions[2] = {(size_t) request.width, (size_t) request.height};
+    size_t pixelCount = (size_t) request.width * request.height;
+    int iterations = request.iterations;
+    int threshold = request.antialiasThreshold;
+
+    cl_int clError = CL_SUCCESS;
+
+    if (edgeCountBuffer == nullptr) {
+        edgeCountBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(cl_int), nullptr, &clError);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create edge buffer!\n";
+            edgeCountBuffer = nullptr;
+            return false;
+        }
+    }
+
+    if (pixelCount > edgesCapacity) {
+        if (edgesBuffer) clReleaseMemObject(edgesBuffer);
+        edgesCapacity = 0;
+
+        edgesBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, pixelCount * sizeof(cl_int), nullptr, &clError);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create edge buffer!\n";
+            edgesBuffer = nullptr;
+            return false;
+        }
+
+        edgesCapacity = pixelCount;
+    }
+
+    edgeCount = 0;
+
+    clError = clEnqueueWriteBuffer(commandQueue, edgeCountBuffer, CL_FALSE, 0, sizeof(cl_int), &edgeCount, 0, nullptr, nullptr);
+
+    clError |= clSetKernelArg(program.edgeKernel, 0, sizeof(cl_int2), dimensions);
+    clError |= clSetKernelArg(program.edgeKernel, 1, sizeof(cl_mem), &fieldBuffer);
+    clError |= clSetKernelArg(program.edgeKernel, 2, sizeof(cl_int), &iterations);
+    clError |= clSetKernelArg(program.edgeKernel, 3, sizeof(cl_int), &threshold);
+    clError |= clSetKernelArg(program.edgeKernel, 4, sizeof(cl_mem), &edgeCountBuffer);
+    clError |= clSetKernelArg(program.edgeKernel, 5, sizeof(cl_mem), &edgesBuffer);
+
+    if (clError == CL_SUCCESS) clError = clEnqueueNDRangeKernel(commandQueue, program.edgeKernel, 2, nullptr, szDimensions, nullptr, 0, nullptr, nullptr);
+    if (clError == CL_SUCCESS) clError = clEnqueueReadBuffer(commandQueue, edgeCountBuffer, CL_TRUE, 0, sizeof(cl_int), &edgeCount, 0, nullptr, nullptr);
+
+    if (clError != CL_SUCCESS) {
+        std::cout << "An error occured when trying to find the edges of the field!\n";
+        edgeCount = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool GpuBackend::SampleEdges(const RenderRequest &request, cl_kernel kernel) {
+    if (edgeCount == 0) return true;
+
+    int sampleCount = request.antialias;
+    size_t total = (size_t) edgeCount * sampleCount;
+
+    cl_int clError = CL_SUCCESS;
+
+    if (total > samplesCapacity) {
+        if (samplesBuffer) clReleaseMemObject(samplesBuffer);
+        samplesCapacity = 0;
+
+        samplesBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE, total * sizeof(cl_float), nullptr, &clError);
+        if (clError != CL_SUCCESS) {
+            std::cout << "An error occured when trying to create sample buffer!\n";
+            samplesBuffer = nullptr;
+            return false;
+        }
+
+        samplesCapacity = total;
+    }
+
+    clError = clSetKernelArg(kernel, 9, sizeof(cl_int), &edgeCount);
+    clError |= clSetKernelArg(kernel, 10, sizeof(cl_mem), &edgesBuffer);
+    clError |= clSetKernelArg(kernel, 11, sizeof(cl_int), &sampleCount);
+    clError |= clSetKernelArg(kernel, 12, sizeof(cl_mem), &samplesBuffer);
+
+    if (clError == CL_SUCCESS) clError = clEnqueueNDRangeKernel(commandQueue, kernel, 1, nullptr, &total, nullptr, 0, nullptr, nullptr);
+
+    return clError == CL_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define CL_TARGET_OPENCL_VERSION 220
+#include <CL/cl.h>
+
+#include "core/render.hpp"
+
+enum class GpuDeviceType {
+    Default,
+    Gpu,
+    // OpenCL runtimes that run on the host processor, such as PoCL
+    Cpu
+};
+
+struct GpuOptions {
+    GpuDeviceType deviceType = GpuDeviceType::Default;
+
+    // Compiled program binaries are stored here, keyed by device, kernel source and fractal. Empty disables the cache
+    std::string cacheDirectory = "kernel-cache";
+};
+
+// Kernel runs on each pixel at once, writing escape counts to a field on the device that a second kernel colours
+// through a palette buffer. The context and buffers are created on the first render, the program of each
+// fractal on the first render of that fractal, and all are kept for the following ones
+class GpuBackend : public RenderBackend {
+public:
+    explicit GpuBackend(const GpuOptions &options = GpuOptions());
+    ~GpuBackend();
+
+    GpuBackend(const GpuBackend &) = delete;
+    GpuBackend &operator=(const GpuBackend &) = delete;
+
+    const char *GetName() const override { return "GPU Accelerated"; }
+
+    bool Render(const RenderRequest &request, sf::Image &image) override;
+
+    // Runs only the colouring kernel over the field of the last frame
+    bool Recolor(const RenderRequest &request, sf::Image &image) override;
+
+    // Whether the last program that had to be built was loaded from the binary cache
+    bool IsProgramCached() const { return programCached; }
+
+    int GetThreadCount() const override { return 0; }
+
+private:
+    // The kernel source built for one fractal
+    struct Program {
+        cl_program program = nullptr;
+        cl_kernel floatKernel = nullptr;
+        cl_kernel doubleFloatKernel = nullptr;
+        cl_kernel colorKernel = nullptr;
+        cl_kernel rangeKernel = nullptr;
+        cl_kernel histogramKernel = nullptr;
+        cl_kernel edgeKernel = nullptr;
+        cl_kernel sampleKernel = nullptr;
+        cl_kernel sampleDfKernel = nullptr;
+        cl_kernel resolveKernel = nullptr;
+    };
+
+    bool Initialize();
+    bool BuildProgram(const std::string &buildOptions, Program &built);
+    bool ReserveBuffers(int width, int height);
+
+    // Colours the field through the palette of request into image, uploading the palette when it changed
+    bool ShadeField(const RenderRequest &request, Program &program, sf::Image &image);
+
+    // Builds the histogram of the field per workgroup and uploads the palette position of every count from low on
+    bool EqualizeField(const RenderRequest &request, Program &program, int &low, int &bins);
+
+    // Compacts the edge pixels of the field into edgesBuffer and reads back how many there are
+    bool FindEdges(const RenderRequest &request, Program &program);
+
+    // Samples every edge with kernel, whose frame arguments are already set
+    bool SampleEdges(const RenderRequest &request, cl_kernel kernel);
+
+    // Whether the samples of the field are the ones request asks for
+    bool CanResolveEdges(const RenderRequest &request) const {
+        return request.antialias == 0 ||
+               (request.antialias == fieldRequest.antialias && request.antialiasThreshold == fieldRequest.antialiasThreshold);
+    }
+
+    void Release();
+
+    // Program for the fractal of request, built on first use. nullptr when the build fails
+    Program *GetProgram(const RenderRequest &request);
+
+    std::string GetCachePath(const std::string &buildOptions) const;
+
+    GpuOptions options;
+
+    cl_device_id device = nullptr;
+    cl_context context = nullptr;
+    cl_command_queue commandQueue = nullptr;
+    bool programCached = false;
+
+    // Keyed by the -D options that pick the fractal
+    std::map<std::string, Program> programs;
+
+    // Escape counts and fractions of the last frame, and the pixels coloured from them
+    cl_mem fieldBuffer = nullptr;
+    cl_mem buffer = nullptr;
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t bufferSize = 0;
+
+    // The field is only recoloured for requests of the same size, limit and smoothing as the one that filled it
+    RenderRequest fieldRequest;
+    bool hasField = false;
+
+    cl_mem paletteBuffer = nullptr;
+    PaletteType uploadedPalette = PaletteType::Greyscale;
+    bool paletteUploaded = false;
+
+    // Equalization, levelsBuffer has room for histogramCapacity + 1 levels
+    cl_mem rangeBuffer = nullptr;
+    cl_mem histogramBuffer = nullptr;
+    cl_mem levelsBuffer = nullptr;
+    size_t histogramCapacity = 0;
+    std::vector<cl_uint> histogram;
+    std::vector<float> levels;
+
+    // Anti-aliasing, edgesBuffer has room for edgesCapacity pixels and samplesBuffer for samplesCapacity samples,
+    // each a value like those of the field
+    cl_mem edgeCountBuffer = nullptr;
+    cl_mem edgesBuffer = nullptr;
+    cl_mem samplesBuffer = nullptr;
+    size_t edgesCapacity = 0;
+    size_t samplesCapacity = 0;
+    int edgeCount = 0;
+};
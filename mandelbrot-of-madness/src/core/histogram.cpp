@@ -0,0 +1,144 @@
+#include <algorithm>
+
+#include "core/histogram.hpp"
+#include "core/palette.hpp"
+
+void HistogramEqualizer::Build(const uint32_t *counts, size_t size, int iterations, ThreadPool *pool) {
+    int threadcount = pool ? pool->GetThreadCount() : 1;
+    uint32_t limit = iterations;
+
+    auto runOnAll = [&](const ThreadPool::Job &job) {
+        if (pool) pool->RunOnAll(job);
+        else job(0);
+    };
+
+    if (levels.size() < (size_t) iterations + 1) levels.resize((size_t) iterations + 1);
+    histograms.resize(threadcount);
+
+    // Range of escaped counts, so the histograms only span the counts that are in the frame. Deep zooms with a high
+    // limit often sit in a narrow band far from 0
+    std::vector<uint32_t> lows(threadcount, limit);
+    std::vector<uint32_t> highs(threadcount, 0);
+
+    runOnAll([&](int thread) {
+        size_t from = size * thread / threadcount;
+        size_t to = size * (thread + 1) / threadcount;
+        uint32_t low = limit;
+        uint32_t high = 0;
+
+        for (size_t i = from; i < to; i++) {
+            uint32_t count = counts[i];
+
+            if (count < limit) {
+                low = std::min(low, count);
+                high = std::max(high, count);
+            }
+        }
+
+        lows[thread] = low;
+        highs[thread] = high;
+    });
+
+    uint32_t low = *std::min_element(lows.begin(), lows.end());
+    uint32_t high = *std::max_element(highs.begin(), highs.end());
+
+    // Nothing escaped, every pixel takes the interior colour and anything else the end of the palette
+    if (low >= limit) {
+        std::fill(levels.begin(), levels.begin() + iterations + 1, (float) paletteSize);
+        return;
+    }
+
+    size_t bins = high - low + 1;
+
+    // Each thread clears and fills its own histogram, so its pages also live next to it
+    runOnAll([&](int thread) {
+        std::vector<uint32_t> &histogram = histograms[thread];
+        histogram.assign(bins, 0);
+
+        size_t from = size * thread / threadcount;
+        size_t to = size * (thread + 1) / threadcount;
+
+        for (size_t i = from; i < to; i++) {
+            uint32_t count = counts[i];
+            if (count < limit) histogram[count - low]++;
+        }
+    });
+
+    // Every thread merges one range of bins over all histograms into the first one and sums it
+    std::vector<uint64_t> totals(threadcount, 0);
+
+    runOnAll([&](int thread) {
+        size_t from = bins * thread / threadcount;
+        size_t to = bins * (thread + 1) / threadcount;
+        uint64_t total = 0;
+
+        for (size_t bin = from; bin < to; bin++) {
+            uint32_t merged = histograms[0][bin];
+            for (int other = 1; other < threadcount; other++) merged += histograms[other][bin];
+
+            histograms[0][bin] = merged;
+            total += merged;
+        }
+
+        totals[thread] = total;
+    });
+
+    // Pixels below each range, one entry per thread
+    std::vector<uint64_t> offsets(threadcount, 0);
+    for (int thread = 1; thread < threadcount; thread++) offsets[thread] = offsets[thread - 1] + totals[thread - 1];
+
+    uint64_t escaped = offsets[threadcount - 1] + totals[threadcount - 1];
+    double scale = (double) paletteSize / (double) escaped;
+
+    // A count sits at the share of escaped pixels below it, so the palette is spread evenly over the pixels
+    runOnAll([&](int thread) {
+        size_t from = bins * thread / threadcount;
+        size_t to = bins * (thread + 1) / threadcount;
+        uint64_t below = offsets[thread];
+
+        for (size_t bin = from; bin < to; bin++) {
+            levels[low + bin] = (float) (below * scale);
+            below += histograms[0][bin];
+        }
+    });
+
+    // Counts outside the frame, such as those of anti-aliasing samples, go to either end of the palette
+    std::fill(levels.begin(), levels.begin() + low, 0.0f);
+    std::fill(levels.begin() + high + 1, levels.begin() + iterations + 1, (float) paletteSize);
+}
+
+void HistogramEqualizer::Clear(int iterations) {
+    added.assign((size_t) iterations + 1, 0);
+}
+
+void HistogramEqualizer::Add(const uint32_t *counts, size_t size) {
+    uint32_t limit = added.size() - 1;
+
+    for (size_t i = 0; i < size; i++) added[std::min(counts[i], limit)]++;
+}
+
+void HistogramEqualizer::BuildAdded() {
+    size_t limit = added.size() - 1;
+
+    if (levels.size() < limit + 1) levels.resize(limit + 1);
+
+    uint64_t escaped = 0;
+    for (size_t count = 0; count < limit; count++) escaped += added[count];
+
+    // Nothing escaped, as in Build
+    if (escaped == 0) {
+        std::fill(levels.begin(), levels.begin() + limit + 1, (float) paletteSize);
+        return;
+    }
+
+    // Counts below the lowest escaped one sit at 0 and those above the highest at paletteSize, as in Build
+    double scale = (double) paletteSize / (double) escaped;
+    uint64_t below = 0;
+
+    for (size_t count = 0; count < limit; count++) {
+        levels[count] = (float) (below * scale);
+        below += added[count];
+    }
+
+    levels[limit] = (float) paletteSize;
+}
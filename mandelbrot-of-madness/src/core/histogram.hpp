@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/thread-pool.hpp"
+
+// Palette positions for histogram-equalized colouring, where every count gets a share of the palette in proportion
+// to the pixels that escaped at it. Every thread counts its own share of the frame into its own histogram over the
+// range of counts in the frame, the threads then merge and sum disjoint ranges of bins, and only the running totals
+// of the ranges are added up in order, so nothing in it grows with the frame on one thread
+class HistogramEqualizer {
+public:
+    // Builds the levels for size escape counts with a limit of iterations, on pool or on the calling thread when
+    // pool is null
+    void Build(const uint32_t *counts, size_t size, int iterations, ThreadPool *pool);
+
+    // Frames seen one part at a time, such as streamed bands, are counted into one histogram over all counts up to
+    // iterations with Add after a Clear, and BuildAdded gives the levels of the whole frame
+    void Clear(int iterations);
+    void Add(const uint32_t *counts, size_t size);
+    void BuildAdded();
+
+    // Palette position of every count below the iteration limit and of the limit itself, so a count n with a smooth
+    // fraction f sits at levels[n] + f * (levels[n + 1] - levels[n])
+    const float *GetLevels() const { return levels.data(); }
+
+private:
+    std::vector<std::vector<uint32_t>> histograms;
+    std::vector<float> levels;
+
+    // Histogram of the parts added since the last Clear
+    std::vector<uint64_t> added;
+};
@@ -0,0 +1,23 @@
+#include <algorithm>
+#include <cctype>
+
+#include "core/image-writer.hpp"
+
+std::string GetExtension(const std::string &filepath) {
+    size_t dot = filepath.find_last_of('.');
+    if (dot == std::string::npos) return "";
+
+    std::string extension = filepath.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    return extension;
+}
+
+std::unique_ptr<RowWriter> CreateRowWriter(const std::string &filepath) {
+    std::string extension = GetExtension(filepath);
+
+    if (extension == "png") return std::unique_ptr<RowWriter>(new PngRowWriter());
+    if (extension == "tif" || extension == "tiff") return std::unique_ptr<RowWriter>(new TiffRowWriter());
+
+    return nullptr;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Encoder that takes an image a few rows at a time, so the whole frame never has to be in memory
+class RowWriter {
+public:
+    virtual ~RowWriter() = default;
+
+    virtual bool Open(const std::string &filepath, int width, int height) = 0;
+
+    // Appends rows of RGBA8 pixels, width * 4 bytes each, below the ones written so far
+    virtual bool WriteRows(const uint8_t *pixels, int rows) = 0;
+
+    // Finishes the file once every row has been written
+    virtual bool Close() = 0;
+};
+
+// Streams PNG through libpng
+class PngRowWriter : public RowWriter {
+public:
+    PngRowWriter();
+    ~PngRowWriter() override;
+
+    bool Open(const std::string &filepath, int width, int height) override;
+    bool WriteRows(const uint8_t *pixels, int rows) override;
+    bool Close() override;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+// Uncompressed RGB TIFF, one strip per row. Switches to BigTIFF when the file would not fit 32-bit offsets
+class TiffRowWriter : public RowWriter {
+public:
+    TiffRowWriter();
+    ~TiffRowWriter() override;
+
+    bool Open(const std::string &filepath, int width, int height) override;
+    bool WriteRows(const uint8_t *pixels, int rows) override;
+    bool Close() override;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+// Lowercase extension of filepath without the dot, empty when it has none
+std::string GetExtension(const std::string &filepath);
+
+// Picks the encoder from the file extension, .png or .tif/.tiff. Returns nullptr for anything else
+std::unique_ptr<RowWriter> CreateRowWriter(const std::string &filepath);
+
+// Encodes a whole frame of RGBA8 pixels as PNG into out, with the fastest compression since it's meant for images
+// that are sent right away. Flipped frames are written bottom row first, which puts the imaginary axis upwards
+bool EncodePng(const uint8_t *pixels, int width, int height, bool flipped, std::vector<uint8_t> &out);
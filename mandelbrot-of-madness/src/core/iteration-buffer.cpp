@@ -0,0 +1,64 @@
+#include <cstdlib>
+#include <new>
+
+#include "core/iteration-buffer.hpp"
+
+// Cache line aligned, which also covers the widest vector store the span kernels do
+static const size_t bufferAlignment = 64;
+
+static void *AlignedAllocate(size_t size) {
+    size = (size + bufferAlignment - 1) / bufferAlignment * bufferAlignment;
+
+#if defined(_WIN32)
+    void *memory = _aligned_malloc(size, bufferAlignment);
+#else
+    void *memory = std::aligned_alloc(bufferAlignment, size);
+#endif
+
+    if (memory == nullptr) throw std::bad_alloc();
+    return memory;
+}
+
+static void AlignedFree(void *memory) {
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+IterationBuffer::~IterationBuffer() {
+    AlignedFree(counts);
+    AlignedFree(fractions);
+}
+
+bool IterationBuffer::Reserve(int width, int height, bool fractions) {
+    size_t size = (size_t) width * height;
+    bool fresh = false;
+
+    this->width = width;
+    this->height = height;
+    hasFractions = fractions;
+
+    if (size > capacity) {
+        AlignedFree(counts);
+        counts = nullptr;
+        capacity = 0;
+
+        counts = (uint32_t *) AlignedAllocate(size * sizeof(uint32_t));
+        capacity = size;
+        fresh = true;
+    }
+
+    if (fractions && size > fractionsCapacity) {
+        AlignedFree(this->fractions);
+        this->fractions = nullptr;
+        fractionsCapacity = 0;
+
+        this->fractions = (float *) AlignedAllocate(size * sizeof(float));
+        fractionsCapacity = size;
+        fresh = true;
+    }
+
+    return fresh;
+}
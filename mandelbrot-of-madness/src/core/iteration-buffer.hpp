@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Raw escape counts of a frame, one per pixel in row-major order, with interior points holding the full
+// iteration count. Backends keep theirs between frames, so a finished view can be recoloured without recomputing it
+class IterationBuffer {
+public:
+    IterationBuffer() = default;
+    ~IterationBuffer();
+
+    IterationBuffer(const IterationBuffer &) = delete;
+    IterationBuffer &operator=(const IterationBuffer &) = delete;
+
+    // Makes room for width x height counts, and as many smooth fractions when fractions is set. Returns true when
+    // that took a fresh allocation, whose pages haven't been touched yet
+    bool Reserve(int width, int height, bool fractions = false);
+
+    uint32_t *GetCounts() { return counts; }
+    const uint32_t *GetCounts() const { return counts; }
+
+    // Fraction of an iteration past the count of every escaped pixel of a smooth frame, nullptr for other frames
+    float *GetFractions() { return hasFractions ? fractions : nullptr; }
+    const float *GetFractions() const { return hasFractions ? fractions : nullptr; }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+private:
+    uint32_t *counts = nullptr;
+    size_t capacity = 0;
+
+    float *fractions = nullptr;
+    size_t fractionsCapacity = 0;
+    bool hasFractions = false;
+
+    int width = 0;
+    int height = 0;
+};
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+
+#include "core/multithreaded-backend.hpp"
+#include "core/cpu-kernel.hpp"
+
+MultiThreadedBackend::MultiThreadedBackend(const MultiThreadedOptions &options) : options(options), pool(options.threadcount, options.pinThreads) {
+
+}
+
+void MultiThreadedBackend::ReserveBuffers(int width, int height, bool fractions) {
+    size_t size = (size_t) width * height;
+
+    // Fresh allocations leave the pages untouched, so the first write decides where they live
+    bool fresh = iterationBuffer.Reserve(width, height, fractions);
+
+    if (size > pixelsSize) {
+        pixels.reset(new uint8_t[size * 4]);
+        pixelsSize = size;
+        fresh = true;
+    }
+
+    if (fresh && options.numaFirstTouch) {
+        uint32_t *counts = iterationBuffer.GetCounts();
+        float *fractionPlane = iterationBuffer.GetFractions();
+        uint8_t *rgba = pixels.get();
+        int threadcount = pool.GetThreadCount();
+
+        // Same contiguous shares the tile scheduler starts every thread on
+        pool.RunOnAll([&](int thread) {
+            size_t from = size * thread / threadcount;
+            size_t to = size * (thread + 1) / threadcount;
+
+            std::fill(counts + from, counts + to, 0);
+            if (fractionPlane) std::fill(fractionPlane + from, fractionPlane + to, 0.0f);
+            std::fill(rgba + from * 4, rgba + to * 4, 0);
+        });
+    }
+}
+
+bool MultiThreadedBackend::Render(const RenderRequest &request, sf::Image &image) {
+    int width = request.width;
+    int height = request.height;
+
+    ReserveBuffers(width, height, request.smooth);
+
+    uint32_t *counts = iterationBuffer.GetCounts();
+    float *fractions = iterationBuffer.GetFractions();
+    uint8_t *rgba = pixels.get();
+
+    int tileSize = request.mode == RenderMode::Subdivide ? options.subdivideTileSize : options.tileSize;
+
+    // Subdivided frames fill pixels they never iterate, so they have no orbit state to keep. Neither do smooth frames,
+    // whose fractions the continuation has no room for
+    bool resume = options.keepContinuation && request.mode == RenderMode::PerPixel && !request.smooth;
+    if (resume && continuation.IsEmpty()) continuation.Reset(request);
+
+    int frameX = 0;
+    int frameY = 0;
+    resume = resume && continuation.Locate(request, frameX, frameY);
+
+    if (resume && (size_t) width * height > orbitsSize) {
+        orbitsSize = (size_t) width * height;
+        orbits.reset(new double[orbitsSize * 2]);
+    }
+
+    // Each tile is shaded right after it is computed, while its escape counts are still in cache. Equalized frames
+    // need the histogram of every count first, so they are shaded in a second pass
+    scheduler.Run(width, height, tileSize, pool, [&](const Tile &tile) {
+        if (resume) CalculateContinuedTile(counts, orbits.get(), continuation, request, frameX, frameY, tile.x, tile.y, tile.width, tile.height);
+        else CalculateMandelbrotTile(counts, fractions, request, tile.x, tile.y, tile.width, tile.height);
+
+        if (!request.equalize) ShadeTile(counts, fractions, request, nullptr, rgba, width, tile.x, tile.y, tile.width, tile.height);
+    });
+
+    supersampler.Sample(counts, request, &pool, [&](int x, int y, double dx, double dy, float *fraction) {
+        std::complex<double> point = PixelToPoint(request, x, y) + std::complex<double>(dx, dy) / request.resolution;
+        return CalculateMandelbrotPoint(request, point.real(), point.imag(), fraction);
+    });
+
+    if (request.equalize) Shade(request);
+    else supersampler.Resolve(request, nullptr, rgba, &pool);
+
+    image = sf::Image(sf::Vector2u(width, height), rgba);
+
+    return true;
+}
+
+void MultiThreadedBackend::Shade(const RenderRequest &request) {
+    int width = request.width;
+    const uint32_t *counts = iterationBuffer.GetCounts();
+    const float *levels = nullptr;
+
+    if (request.equalize && request.levels) {
+        levels = request.levels;
+    } else if (request.equalize) {
+        equalizer.Build(counts, (size_t) width * request.height, request.iterations, &pool);
+        levels = equalizer.GetLevels();
+    }
+
+    // Only the colouring pass, over the same tiles the counts were computed in
+    scheduler.Run(width, request.height, options.tileSize, pool, [&](const Tile &tile) {
+        ShadeTile(counts, iterationBuffer.GetFractions(), request, levels, pixels.get(), width, tile.x, tile.y, tile.width, tile.height);
+    });
+
+    supersampler.Resolve(request, levels, pixels.get(), &pool);
+}
+
+bool MultiThreadedBackend::Recolor(const RenderRequest &request, sf::Image &image) {
+    if (!CanRecolor(iterationBuffer, request) || !supersampler.CanResolve(request)) return false;
+
+    Shade(request);
+
+    image = sf::Image(sf::Vector2u(request.width, request.height), pixels.get());
+
+    return true;
+}
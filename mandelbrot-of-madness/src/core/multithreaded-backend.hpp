@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/render.hpp"
+#include "core/iteration-buffer.hpp"
+#include "core/continuation.hpp"
+#include "core/histogram.hpp"
+#include "core/supersample.hpp"
+#include "core/thread-pool.hpp"
+#include "core/tile-scheduler.hpp"
+
+struct MultiThreadedOptions {
+    // 0 uses every hardware thread
+    int threadcount = 0;
+    int tileSize = 32;
+
+    // Larger tiles for RenderMode::Subdivide, so there is room to fill uniform rectangles
+    int subdivideTileSize = 128;
+
+    // Binds each pool worker to one core
+    bool pinThreads = false;
+
+    // Has each worker zero its own share of freshly allocated buffers so that, with pinned threads,
+    // the pages are placed on the NUMA node of the core that renders them
+    bool numaFirstTouch = false;
+
+    // Keeps the orbit state of every pixel of RenderMode::PerPixel frames, so raising the iteration limit of the
+    // same view only resumes the pixels that were still running. Costs 25 bytes per pixel of the frame
+    bool keepContinuation = false;
+};
+
+// Small square tiles shared out over a work-stealing scheduler running on a persistent pool
+class MultiThreadedBackend : public RenderBackend {
+public:
+    explicit MultiThreadedBackend(const MultiThreadedOptions &options = MultiThreadedOptions());
+
+    const char *GetName() const override { return "Multithreaded"; }
+
+    bool Render(const RenderRequest &request, sf::Image &image) override;
+    bool Recolor(const RenderRequest &request, sf::Image &image) override;
+
+    // Busy and idle time of every thread during the last frame
+    const std::vector<ThreadStats> &GetThreadStats() const { return scheduler.GetStats(); }
+
+    // Escape counts of the last frame
+    const IterationBuffer *GetIterations() const override { return &iterationBuffer; }
+
+    ThreadPool &GetPool() { return pool; }
+
+    int GetThreadCount() const override { return pool.GetThreadCount(); }
+
+    // Starts out empty and takes the first request as its frame, reset it to render another view
+    Continuation *GetContinuation() override { return options.keepContinuation ? &continuation : nullptr; }
+
+private:
+    void ReserveBuffers(int width, int height, bool fractions);
+
+    // Colours the escape counts and edge samples of the last frame into pixels
+    void Shade(const RenderRequest &request);
+
+    MultiThreadedOptions options;
+    ThreadPool pool;
+    TileScheduler scheduler;
+
+    // Kept between frames so animation and benchmark runs don't reallocate them
+    IterationBuffer iterationBuffer;
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t pixelsSize = 0;
+    HistogramEqualizer equalizer;
+    EdgeSupersampler supersampler;
+
+    Continuation continuation;
+
+    // Last z of the pixels computed from scratch, before they are sorted into the continuation
+    std::unique_ptr<double[]> orbits;
+    size_t orbitsSize = 0;
+};
@@ -0,0 +1,86 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "core/palette.hpp"
+
+// A colour at a position in [0, 1] of the gradient, the stops in between are interpolated linearly
+struct PaletteStop {
+    float position;
+    float r, g, b;
+};
+
+static std::vector<uint32_t> BuildTable(const std::vector<PaletteStop> &stops, const float inside[3]) {
+    std::vector<uint32_t> table(paletteSize + 1);
+    size_t next = 1;
+
+    for (int i = 0; i <= paletteSize; i++) {
+        float position = (float) i / paletteSize;
+        float color[3] = {inside[0], inside[1], inside[2]};
+
+        if (i < paletteSize) {
+            while (next + 1 < stops.size() && stops[next].position < position) next++;
+
+            const PaletteStop &a = stops[next - 1];
+            const PaletteStop &b = stops[next];
+            float t = b.position > a.position ? (position - a.position) / (b.position - a.position) : 0;
+
+            color[0] = a.r + (b.r - a.r) * t;
+            color[1] = a.g + (b.g - a.g) * t;
+            color[2] = a.b + (b.b - a.b) * t;
+        }
+
+        uint8_t bytes[4] = {(uint8_t) color[0], (uint8_t) color[1], (uint8_t) color[2], 255};
+        std::memcpy(&table[i], bytes, 4);
+    }
+
+    return table;
+}
+
+static std::vector<uint32_t> BuildRainbow() {
+    std::vector<PaletteStop> stops;
+
+    // Full saturation hue circle, ending where it started so a cycling palette has no seam
+    for (int step = 0; step <= 6; step++) {
+        float hue = step / 6.0f;
+        float channels[3];
+
+        // HSV to RGB at full saturation and value, red, green and blue peak a third of the circle apart
+        for (int c = 0; c < 3; c++) {
+            float k = std::fmod(5 - 2 * c + hue * 6, 6.0f);
+            channels[c] = 255 * (1 - std::fmax(0.0f, std::fmin(std::fmin(k, 4 - k), 1.0f)));
+        }
+
+        stops.push_back({hue, channels[0], channels[1], channels[2]});
+    }
+
+    const float black[3] = {0, 0, 0};
+    return BuildTable(stops, black);
+}
+
+const uint32_t *GetPaletteTable(PaletteType palette) {
+    static const float black[3] = {0, 0, 0};
+
+    // Function statics are built once even when several threads shade at the same time
+    static const std::vector<uint32_t> greyscale = BuildTable({{0, 255, 255, 255}, {1, 0, 0, 0}}, black);
+    static const std::vector<uint32_t> fire = BuildTable({{0, 0, 0, 0}, {0.3f, 200, 20, 0}, {0.6f, 255, 160, 0}, {0.85f, 255, 240, 100}, {1, 255, 255, 255}}, black);
+    static const std::vector<uint32_t> ocean = BuildTable({{0, 0, 7, 100}, {0.16f, 32, 107, 203}, {0.42f, 237, 255, 255}, {0.6425f, 255, 170, 0}, {0.8575f, 0, 2, 0}, {1, 0, 7, 100}}, black);
+    static const std::vector<uint32_t> rainbow = BuildRainbow();
+
+    switch (palette) {
+        case PaletteType::Fire: return fire.data();
+        case PaletteType::Ocean: return ocean.data();
+        case PaletteType::Rainbow: return rainbow.data();
+        default: return greyscale.data();
+    }
+}
+
+bool ParsePalette(const std::string &name, PaletteType &palette) {
+    if (name == "greyscale") palette = PaletteType::Greyscale;
+    else if (name == "fire") palette = PaletteType::Fire;
+    else if (name == "ocean") palette = PaletteType::Ocean;
+    else if (name == "rainbow") palette = PaletteType::Rainbow;
+    else return false;
+
+    return true;
+}
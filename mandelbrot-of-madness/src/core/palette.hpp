@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "core/render.hpp"
+
+// Entries of a palette lookup table, a power of two so cycling palettes wrap with a mask
+const int paletteSize = 1024;
+
+// RGBA8 lookup table of palette, paletteSize entries from the outside of the set inwards followed by the colour of
+// points that never escaped. Each entry holds the bytes r, g, b, a in memory order, so it can be uploaded as is as
+// an OpenCL buffer or a texture. Built on first use and shared for the rest of the run
+const uint32_t *GetPaletteTable(PaletteType palette);
+
+// Position in the table of an escape count plus its smooth fraction, as a multiplier of the count
+inline float GetPaletteScale(const RenderRequest &request) {
+    return (float) paletteSize / (float) (request.paletteCycle > 0 ? request.paletteCycle : request.iterations);
+}
+
+// Reads greyscale, fire, ocean or rainbow. Returns false for any other name
+bool ParsePalette(const std::string &name, PaletteType &palette);
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "core/perturbation-backend.hpp"
+#include "core/bigfloat.hpp"
+#include "core/cpu-kernel.hpp"
+
+// Requests whose pivot is within this many pixels of the last reference keep using its orbit
+const double referenceReuseDistance = 65536;
+
+PerturbationBackend::PerturbationBackend(const MultiThreadedOptions &options) : options(options), pool(options.threadcount, options.pinThreads) {
+
+}
+
+void PerturbationBackend::ComputeReferenceOrbit(const RenderRequest &request, bool resume) {
+    int limbs = BigFloat::LimbsForResolution(request.resolution * std::max(request.width, request.height));
+
+    BigFloat cr = request.deepPivotReal.empty() ? BigFloat::FromDouble(request.pivot.real(), limbs) : BigFloat::FromString(request.deepPivotReal, limbs);
+    BigFloat ci = request.deepPivotImag.empty() ? BigFloat::FromDouble(request.pivot.imag(), limbs) : BigFloat::FromString(request.deepPivotImag, limbs);
+
+    BigFloat targetReal = cr;
+    BigFloat targetImag = ci;
+    bool reuse = !orbit.empty() && referenceReal.GetFractionLimbs() >= limbs;
+
+    // Offsets saved in the continuation are relative to its reference, so that has to be the one used
+    bool pinned = resume && !continuation.GetReferenceReal().empty();
+
+    if (pinned) {
+        BigFloat pinnedReal = BigFloat::FromString(continuation.GetReferenceReal(), limbs);
+        BigFloat pinnedImag = BigFloat::FromString(continuation.GetReferenceImag(), limbs);
+
+        // A frame panned far from its reference drops its state rather than keep using a distant orbit
+        std::complex<double> offset((cr - pinnedReal).ToDouble(), (ci - pinnedImag).ToDouble());
+
+        if (std::abs(offset) * request.resolution > referenceReuseDistance) {
+            continuation.Reset(RenderRequest(continuation.GetFrame()));
+            pinned = false;
+        } else {
+            targetReal = pinnedReal;
+            targetImag = pinnedImag;
+        }
+    }
+
+    if (pinned) {
+        reuse = reuse && (targetReal - referenceReal).ToDouble() == 0 && (targetImag - referenceImag).ToDouble() == 0;
+    } else if (reuse) {
+        std::complex<double> offset((cr - referenceReal).ToDouble(), (ci - referenceImag).ToDouble());
+        reuse = std::abs(offset) * request.resolution <= referenceReuseDistance;
+    }
+
+    if (!reuse) {
+        referenceReal = targetReal;
+        referenceImag = targetImag;
+        referencePoint = std::complex<double>(targetReal.ToDouble(), targetImag.ToDouble());
+
+        lastReal = BigFloat(limbs);
+        lastImag = BigFloat(limbs);
+        referenceEscaped = false;
+        orbitIterations = 0;
+
+        orbit.assign(1, 0);
+    }
+
+    pivotOffset = std::complex<double>((cr - referenceReal).ToDouble(), (ci - referenceImag).ToDouble());
+
+    // The test adds the offset of a pixel to the reference in doubles. Once a pixel spans only a few ulps of the
+    // reference, every pixel rounds to nearly the same point and the whole frame would take its classification
+    double ulp = std::numeric_limits<double>::epsilon() * std::max(1.0, std::abs(referencePoint));
+    bulbCheck = request.bulbCheck && 1 / request.resolution > 16 * ulp;
+
+    ExtendReferenceOrbit(request.iterations);
+
+    if (resume && !pinned) continuation.SetReference(referenceReal.ToString(), referenceImag.ToString());
+}
+
+// Only appends to the orbit, so offsets saved against the part computed so far stay valid
+void PerturbationBackend::ExtendReferenceOrbit(int iterations) {
+    if (referenceEscaped || orbitIterations >= iterations) return;
+
+    orbit.reserve(iterations + 1);
+
+    for (int i = orbitIterations; i < iterations; i++) {
+        BigFloat zr2 = lastReal * lastReal;
+        BigFloat zi2 = lastImag * lastImag;
+        BigFloat zri = lastReal * lastImag;
+
+        lastReal = zr2 - zi2 + referenceReal;
+        lastImag = zri + zri + referenceImag;
+        orbitIterations = i + 1;
+
+        std::complex<double> z(lastReal.ToDouble(), lastImag.ToDouble());
+        orbit.push_back(z);
+
+        // An escaped reference is still usable, pixels rebase to its start once they run off the end
+        if (std::norm(z) > 4) {
+            referenceEscaped = true;
+            break;
+        }
+    }
+}
+
+void PerturbationBackend::ComputeSeries(const RenderRequest &request) {
+    // Furthest a pixel gets from the reference, and the spacing between two pixels
+    double deltaReal = std::abs(pivotOffset.real()) + request.width / 2.0 / request.resolution;
+    double deltaImag = std::abs(pivotOffset.imag()) + request.height / 2.0 / request.resolution;
+    double delta = std::hypot(deltaReal, deltaImag);
+    double spacing = 1.0 / request.resolution;
+
+    std::complex<double> a = 0;
+    std::complex<double> b = 0;
+    std::complex<double> c = 0;
+
+    skipped = 0;
+
+    int last = std::min<int>(orbit.size() - 2, request.iterations - 1);
+
+    for (int n = 0; n < last; n++) {
+        std::complex<double> twoZ = 2.0 * orbit[n];
+
+        std::complex<double> nextA = twoZ * a + 1.0;
+        std::complex<double> nextB = twoZ * b + a * a;
+        std::complex<double> nextC = twoZ * c + 2.0 * a * b;
+
+        // Stop once the truncated cubic term could move a pixel by more than a thousandth of its spacing
+        double error = std::abs(nextC) * delta * delta * delta;
+        if (!std::isfinite(error) || error > 1e-3 * std::abs(nextA) * spacing) break;
+
+        a = nextA;
+        b = nextB;
+        c = nextC;
+        skipped = n + 1;
+    }
+
+    seriesA = a;
+    seriesB = b;
+    seriesC = c;
+}
+
+// Carries the offset dz from position m of the reference orbit on until the pixel escapes past bailout or reaches
+// the limit. Returns the iteration count it stopped at and leaves |z|^2 there in norm
+static int IterateOffset(const std::complex<double> *reference, int last, double dcr, double dci, double &dzr, double &dzi, int &m, int iter, int iterations, double bailout, double &norm) {
+    double zr = reference[m].real() + dzr;
+    double zi = reference[m].imag() + dzi;
+
+    while (iter < iterations && zr * zr + zi * zi < bailout) {
+        // dz' = (2Z + dz) dz + dc
+        double tr = 2 * reference[m].real() + dzr;
+        double ti = 2 * reference[m].imag() + dzi;
+
+        double nextR = tr * dzr - ti * dzi + dcr;
+        double nextI = tr * dzi + ti * dzr + dci;
+
+        dzr = nextR;
+        dzi = nextI;
+        m++;
+        iter++;
+
+        zr = reference[m].real() + dzr;
+        zi = reference[m].imag() + dzi;
+
+        // Rebase onto Z_0 = 0 when the pixel's orbit gets closer to zero than to the reference
+        if (zr * zr + zi * zi < dzr * dzr + dzi * dzi || m == last) {
+            dzr = zr;
+            dzi = zi;
+            m = 0;
+        }
+    }
+
+    norm = zr * zr + zi * zi;
+    return iter;
+}
+
+void PerturbationBackend::CalculateTile(uint32_t *counts, float *fractions, const RenderRequest &request, const Tile &tile, bool resume, int frameX, int frameY) {
+    int iterations = request.iterations;
+    double bailout = GetBailout<MandelbrotFormula>(request);
+    double norm;
+    int last = orbit.size() - 1;
+    const std::complex<double> *reference = orbit.data();
+
+    PixelState *states = continuation.GetStates();
+    uint32_t *savedCounts = continuation.GetCounts();
+    double *savedReal = continuation.GetOrbitReal();
+    double *savedImag = continuation.GetOrbitImag();
+    uint32_t *savedReferences = continuation.GetReferences();
+
+    for (int y = tile.y; y < tile.y + tile.height; y++) {
+        double dci = pivotOffset.imag() + (y - (float) request.height / 2.0f) / request.resolution;
+
+        for (int x = tile.x; x < tile.x + tile.width; x++) {
+            double dcr = pivotOffset.real() + (x - (float) request.width / 2.0f) / request.resolution;
+            size_t i = resume ? continuation.Index(frameX + x, frameY + y) : 0;
+
+            if (resume && states[i] != PixelState::Unknown) {
+                if (states[i] == PixelState::Running && savedCounts[i] < (uint32_t) iterations) {
+                    int m = savedReferences[i];
+                    int iter = IterateOffset(reference, last, dcr, dci, savedReal[i], savedImag[i], m, savedCounts[i], iterations, bailout, norm);
+
+                    savedCounts[i] = iter;
+                    savedReferences[i] = m;
+                    if (iter < iterations) states[i] = PixelState::Escaped;
+                }
+
+                // Anything that got further than a lowered limit shows as not escaped
+                counts[y * request.width + x] = states[i] == PixelState::Interior ? iterations : std::min<uint32_t>(savedCounts[i], iterations);
+                continue;
+            }
+
+            if (bulbCheck && InMainCardioidOrBulb(referencePoint.real() + dcr, referencePoint.imag() + dci)) {
+                counts[y * request.width + x] = iterations;
+                if (fractions) fractions[y * request.width + x] = 0;
+                if (resume) states[i] = PixelState::Interior;
+                continue;
+            }
+
+            std::complex<double> dc(dcr, dci);
+            std::complex<double> dz = ((seriesC * dc + seriesB) * dc + seriesA) * dc;
+
+            double dzr = dz.real();
+            double dzi = dz.imag();
+            int m = skipped;
+
+            int iter = IterateOffset(reference, last, dcr, dci, dzr, dzi, m, skipped, iterations, bailout, norm);
+            counts[y * request.width + x] = iter;
+            if (fractions) fractions[y * request.width + x] = iter < iterations ? GetSmoothFraction(request, norm) : 0;
+
+            if (resume) {
+                states[i] = iter < iterations ? PixelState::Escaped : PixelState::Running;
+                savedCounts[i] = iter;
+                savedReal[i] = dzr;
+                savedImag[i] = dzi;
+                savedReferences[i] = m;
+            }
+        }
+    }
+}
+
+uint32_t PerturbationBackend::SamplePoint(const RenderRequest &request, double x, double y, float *fraction) const {
+    int iterations = request.iterations;
+    double dcr = pivotOffset.real() + (x - (float) request.width / 2.0f) / request.resolution;
+    double dci = pivotOffset.imag() + (y - (float) request.height / 2.0f) / request.resolution;
+
+    if (fraction) *fraction = 0;
+
+    if (bulbCheck && InMainCardioidOrBulb(referencePoint.real() + dcr, referencePoint.imag() + dci)) return iterations;
+
+    // Samples stay within half a pixel of the frame, which the series was checked over
+    std::complex<double> dc(dcr, dci);
+    std::complex<double> dz = ((seriesC * dc + seriesB) * dc + seriesA) * dc;
+
+    double dzr = dz.real();
+    double dzi = dz.imag();
+    double norm;
+    int m = skipped;
+
+    int iter = IterateOffset(orbit.data(), orbit.size() - 1, dcr, dci, dzr, dzi, m, skipped, iterations, GetBailout<MandelbrotFormula>(request), norm);
+    if (fraction && iter < iterations) *fraction = GetSmoothFraction(request, norm);
+
+    return iter;
+}
+
+bool PerturbationBackend::Render(const RenderRequest &request, sf::Image &image) {
+    int width = request.width;
+    int height = request.height;
+
+    // The series and the offset iteration are both derived from z^2 + c with c at the pixel
+    if (request.fractal != FractalType::Mandelbrot) {
+        std::cout << "An error occured when trying to render, the deep zoom engine only supports the Mandelbrot set!\n";
+        return false;
+    }
+
+    // The continuation has no room for the fractions of smooth frames
+    bool resume = options.keepContinuation && !request.smooth;
+    if (resume && continuation.IsEmpty()) continuation.Reset(request);
+
+    int frameX = 0;
+    int frameY = 0;
+    resume = resume && continuation.Locate(request, frameX, frameY);
+
+    ComputeReferenceOrbit(request, resume);
+    ComputeSeries(request);
+
+    iterationBuffer.Reserve(width, height, request.smooth);
+
+    size_t size = (size_t) width * height;
+    if (size > pixelsSize) {
+        pixels.reset(new uint8_t[size * 4]);
+        pixelsSize = size;
+    }
+
+    uint32_t *counts = iterationBuffer.GetCounts();
+    float *fractions = iterationBuffer.GetFractions();
+    uint8_t *rgba = pixels.get();
+
+    // Equalized frames are shaded once the histogram of the whole frame is known
+    scheduler.Run(width, height, options.tileSize, pool, [&](const Tile &tile) {
+        CalculateTile(counts, fractions, request, tile, resume, frameX, frameY);
+        if (!request.equalize) ShadeTile(counts, fractions, request, nullptr, rgba, width, tile.x, tile.y, tile.width, tile.height);
+    });
+
+    supersampler.Sample(counts, request, &pool, [&](int x, int y, double dx, double dy, float *fraction) {
+        return SamplePoint(request, x + dx, y + dy, fraction);
+    });
+
+    if (request.equalize) Shade(request);
+    else supersampler.Resolve(request, nullptr, rgba, &pool);
+
+    image = sf::Image(sf::Vector2u(width, height), rgba);
+
+    return true;
+}
+
+void PerturbationBackend::Shade(const RenderRequest &request) {
+    int width = request.width;
+    const uint32_t *counts = iterationBuffer.GetCounts();
+    const float *levels = nullptr;
+
+    if (request.equalize && request.levels) {
+        levels = request.levels;
+    } else if (request.equalize) {
+        equalizer.Build(counts, (size_t) width * request.height, request.iterations, &pool);
+        levels = equalizer.GetLevels();
+    }
+
+    scheduler.Run(width, request.height, options.tileSize, pool, [&](const Tile &tile) {
+        ShadeTile(counts, iterationBuffer.GetFractions(), request, levels, pixels.get(), width, tile.x, tile.y, tile.width, tile.height);
+    });
+
+    supersampler.Resolve(request, levels, pixels.get(), &pool);
+}
+
+bool PerturbationBackend::Recolor(const RenderRequest &request, sf::Image &image) {
+    if (!CanRecolor(iterationBuffer, request) || !supersampler.CanResolve(request)) return false;
+
+    Shade(request);
+
+    image = sf::Image(sf::Vector2u(request.width, request.height), pixels.get());
+
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/render.hpp"
+#include "core/bigfloat.hpp"
+#include "core/iteration-buffer.hpp"
+#include "core/continuation.hpp"
+#include "core/histogram.hpp"
+#include "core/supersample.hpp"
+#include "core/multithreaded-backend.hpp"
+
+// Deep zoom renderer. One reference orbit at the pivot is iterated in BigFloat precision, every pixel
+// then only iterates its double precision offset from that orbit. A cubic series approximation skips
+// the iterations where all offsets still behave linearly, and offsets are rebased onto the start of the
+// orbit whenever they get close to it, which avoids glitches without extra references
+class PerturbationBackend : public RenderBackend {
+public:
+    explicit PerturbationBackend(const MultiThreadedOptions &options = MultiThreadedOptions());
+
+    const char *GetName() const override { return "Perturbation"; }
+
+    bool Render(const RenderRequest &request, sf::Image &image) override;
+    bool Recolor(const RenderRequest &request, sf::Image &image) override;
+
+    // Iterations every pixel skipped through the series approximation in the last frame
+    int GetSkippedIterations() const { return skipped; }
+
+    // Escape counts of the last frame
+    const IterationBuffer *GetIterations() const override { return &iterationBuffer; }
+
+    // Length of the last reference orbit, shorter than the iteration count if the pivot escapes
+    int GetReferenceLength() const { return orbit.size(); }
+
+    // Offsets are saved against the reference of the frame, which later renders of it keep using
+    Continuation *GetContinuation() override { return options.keepContinuation ? &continuation : nullptr; }
+
+    int GetThreadCount() const override { return pool.GetThreadCount(); }
+
+private:
+    void ComputeReferenceOrbit(const RenderRequest &request, bool resume);
+    void ExtendReferenceOrbit(int iterations);
+    void ComputeSeries(const RenderRequest &request);
+    void CalculateTile(uint32_t *counts, float *fractions, const RenderRequest &request, const Tile &tile, bool resume, int frameX, int frameY);
+    void Shade(const RenderRequest &request);
+
+    // Escape count of the point at pixel coordinates (x, y) of the frame, which need not be whole
+    uint32_t SamplePoint(const RenderRequest &request, double x, double y, float *fraction) const;
+
+    MultiThreadedOptions options;
+    ThreadPool pool;
+    TileScheduler scheduler;
+
+    IterationBuffer iterationBuffer;
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t pixelsSize = 0;
+    HistogramEqualizer equalizer;
+    EdgeSupersampler supersampler;
+
+    // Reference orbit Z_0 .. Z_n, rounded to double once computed
+    std::vector<std::complex<double>> orbit;
+    BigFloat referenceReal;
+    BigFloat referenceImag;
+    int orbitIterations = 0;
+    std::complex<double> referencePoint;
+
+    // Last point of the orbit at full precision, a higher iteration limit carries on from it
+    BigFloat lastReal;
+    BigFloat lastImag;
+    bool referenceEscaped = false;
+
+    // Pivot of the current request minus the reference. Nonzero when a nearby frame or a region of one reuses
+    // the orbit of an earlier request
+    std::complex<double> pivotOffset;
+
+    // Cardioid/bulb test of the current request, off when its pixels are too small to tell apart in doubles
+    bool bulbCheck = false;
+
+    // Series coefficients at the skipped iteration: dz = A dc + B dc^2 + C dc^3
+    int skipped = 0;
+    std::complex<double> seriesA;
+    std::complex<double> seriesB;
+    std::complex<double> seriesC;
+
+    Continuation continuation;
+};
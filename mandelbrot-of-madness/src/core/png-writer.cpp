@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <iostream>
+
+#include <png.h>
+
+#include "core/image-writer.hpp"
+
+struct PngRowWriter::State {
+    FILE *file = nullptr;
+    png_structp png = nullptr;
+    png_infop info = nullptr;
+    int width = 0;
+};
+
+PngRowWriter::PngRowWriter() = default;
+
+PngRowWriter::~PngRowWriter() {
+    if (!state) return;
+
+    if (state->png) png_destroy_write_struct(&state->png, &state->info);
+    if (state->file) fclose(state->file);
+}
+
+bool PngRowWriter::Open(const std::string &filepath, int width, int height) {
+    state.reset(new State());
+    state->width = width;
+
+    state->file = fopen(filepath.c_str(), "wb");
+    if (state->file == nullptr) {
+        std::cout << "An error occured when trying to open " << filepath << "!\n";
+        return false;
+    }
+
+    state->png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    if (state->png) state->info = png_create_info_struct(state->png);
+
+    if (state->info == nullptr) {
+        std::cout << "An error occured when trying to create png encoder!\n";
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(state->png))) {
+        std::cout << "An error occured when trying to write png header!\n";
+        return false;
+    }
+
+    png_init_io(state->png, state->file);
+    png_set_IHDR(state->png, state->info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(state->png, state->info);
+
+    // Rows come in as RGBA, the always opaque alpha byte is dropped
+    png_set_filler(state->png, 0, PNG_FILLER_AFTER);
+
+    return true;
+}
+
+bool PngRowWriter::WriteRows(const uint8_t *pixels, int rows) {
+    if (setjmp(png_jmpbuf(state->png))) {
+        std::cout << "An error occured when trying to write png rows!\n";
+        return false;
+    }
+
+    for (int row = 0; row < rows; row++) {
+        png_write_row(state->png, pixels + (size_t) row * state->width * 4);
+    }
+
+    return true;
+}
+
+bool PngRowWriter::Close() {
+    if (setjmp(png_jmpbuf(state->png))) {
+        std::cout << "An error occured when trying to finish png!\n";
+        return false;
+    }
+
+    png_write_end(state->png, state->info);
+    png_destroy_write_struct(&state->png, &state->info);
+
+    bool closed = fclose(state->file) == 0;
+    state->file = nullptr;
+
+    if (!closed) std::cout << "An error occured when trying to finish png!\n";
+    return closed;
+}
+
+static void AppendPngData(png_structp png, png_bytep data, png_size_t length) {
+    std::vector<uint8_t> *out = (std::vector<uint8_t> *) png_get_io_ptr(png);
+    out->insert(out->end(), data, data + length);
+}
+
+// Nothing to flush in memory, but without a flush function libpng would fflush the vector pointer as a FILE
+static void FlushPngData(png_structp) {}
+
+bool EncodePng(const uint8_t *pixels, int width, int height, bool flipped, std::vector<uint8_t> &out) {
+    out.clear();
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+
+    if (info == nullptr) {
+        png_destroy_write_struct(&png, nullptr);
+        std::cout << "An error occured when trying to create png encoder!\n";
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        std::cout << "An error occured when trying to encode png!\n";
+        return false;
+    }
+
+    png_set_write_fn(png, &out, AppendPngData, FlushPngData);
+    png_set_compression_level(png, 1);
+    png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    png_set_filler(png, 0, PNG_FILLER_AFTER);
+
+    for (int row = 0; row < height; row++) {
+        int source = flipped ? height - 1 - row : row;
+        png_write_row(png, pixels + (size_t) source * width * 4);
+    }
+
+    png_write_end(png, info);
+    png_destroy_write_struct(&png, &info);
+
+    return true;
+}
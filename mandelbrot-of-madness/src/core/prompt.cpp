@@ -0,0 +1,62 @@
+#include <iostream>
+
+#include "core/prompt.hpp"
+#include "core/streaming-render.hpp"
+#include "core/image-writer.hpp"
+
+void PromptRenderJob(RenderRequest &request, std::string &filepath) {
+    std::cout << "Enter width: ";
+    std::cin >> request.width;
+
+    std::cout << "Enter height: ";
+    std::cin >> request.height;
+
+    std::cout << "Enter resolution: ";
+    std::cin >> request.resolution;
+
+    std::cout << "Enter iterations: ";
+    std::cin >> request.iterations;
+
+    std::cout << "Enter output filepath: ";
+    std::cin >> filepath;
+}
+
+int RenderToFile(RenderBackend &backend, const RenderRequest &request, const std::string &filepath) {
+    // SFML can't save TIFF, and posters would not fit in one sf::Image
+    std::string extension = GetExtension(filepath);
+    bool tiff = extension == "tif" || extension == "tiff";
+
+    if (tiff || (long long) request.width * request.height > streamingPixelThreshold) {
+        if (!RenderStreaming(backend, request, filepath)) {
+            std::cout << "An error occured when trying to stream image!\n";
+            return -1;
+        }
+
+        std::cout << "Successfully generated image";
+        return 0;
+    }
+
+    sf::Image image;
+
+    if (!backend.Render(request, image)) {
+        std::cout << "An error occured when trying to render image!\n";
+        return -1;
+    }
+
+    if (!image.saveToFile(filepath)) {
+        std::cout << "An error occured when trying to save image!\n";
+        return -1;
+    }
+
+    std::cout << "Successfully generated image";
+    return 0;
+}
+
+int RunPromptedRender(RenderBackend &backend) {
+    RenderRequest request;
+    std::string filepath;
+
+    PromptRenderJob(request, filepath);
+
+    return RenderToFile(backend, request, filepath);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+#include "core/render.hpp"
+
+// Asks for the frame parameters and output path on stdin
+void PromptRenderJob(RenderRequest &request, std::string &filepath);
+
+// Renders request with backend and saves the result, streaming it in bands when it's a TIFF or too large to
+// hold in memory. Returns the process exit code
+int RenderToFile(RenderBackend &backend, const RenderRequest &request, const std::string &filepath);
+
+// Prompts for a job, renders it with backend and saves the result. Returns the process exit code
+int RunPromptedRender(RenderBackend &backend);
@@ -0,0 +1,28 @@
+#include <algorithm>
+
+#include "core/region-request.hpp"
+#include "core/bigfloat.hpp"
+
+RenderRequest RegionRequest(const RenderRequest &request, int x, int y, int width, int height) {
+    RenderRequest region = request;
+    region.width = width;
+    region.height = height;
+
+    // Matches the half-size rounding the kernels use when mapping pixels to the plane
+    double offsetReal = (x + (float) width / 2.0f - (float) request.width / 2.0f) / request.resolution;
+    double offsetImag = (y + (float) height / 2.0f - (float) request.height / 2.0f) / request.resolution;
+
+    region.pivot = request.pivot + std::complex<double>(offsetReal, offsetImag);
+
+    int limbs = BigFloat::LimbsForResolution(request.resolution * std::max(request.width, request.height));
+
+    if (!request.deepPivotReal.empty()) {
+        region.deepPivotReal = (BigFloat::FromString(request.deepPivotReal, limbs) + BigFloat::FromDouble(offsetReal, limbs)).ToString();
+    }
+
+    if (!request.deepPivotImag.empty()) {
+        region.deepPivotImag = (BigFloat::FromString(request.deepPivotImag, limbs) + BigFloat::FromDouble(offsetImag, limbs)).ToString();
+    }
+
+    return region;
+}
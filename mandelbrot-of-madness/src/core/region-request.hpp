@@ -0,0 +1,7 @@
+#pragma once
+
+#include "core/render.hpp"
+
+// Request for the width x height block at (x, y) of request, as a frame of its own centered on the middle
+// of the block, so any backend can render part of a frame. Deep pivots are moved in BigFloat precision
+RenderRequest RegionRequest(const RenderRequest &request, int x, int y, int width, int height);
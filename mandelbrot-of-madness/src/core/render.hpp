@@ -0,0 +1,127 @@
+#pragma once
+
+#include <complex>
+#include <string>
+
+#include <SFML/Graphics/Image.hpp>
+
+enum class FractalType {
+    // z^2 + c, starting from z = 0 with c at the pixel
+    Mandelbrot,
+
+    // z^2 + c, starting from z at the pixel with c fixed at RenderRequest::juliaSeed
+    Julia,
+
+    // z^power + c, starting from z = 0 with c at the pixel
+    Multibrot,
+
+    // (|re z| + i|im z|)^2 + c, starting from z = 0 with c at the pixel
+    BurningShip
+};
+
+// Gradients escape counts are looked up in, see core/palette.hpp
+enum class PaletteType {
+    // White outside fading to black at the iteration limit, the original look
+    Greyscale,
+    Fire,
+    Ocean,
+    Rainbow
+};
+
+enum class RenderMode {
+    // Every pixel is iterated, this is the reference the other modes are checked against
+    PerPixel,
+
+    // Mariani-Silver: rectangles whose traced border has one uniform count are filled without iterating
+    Subdivide
+};
+
+// Everything a backend needs to know to produce one frame
+struct RenderRequest {
+    int width = 0;
+    int height = 0;
+    double resolution = 1;
+    int iterations = 0;
+    std::complex<double> pivot;
+
+    // Decimal pivot coordinates for zooms past what a double can address. When set, the
+    // perturbation backend takes its reference point from these instead of pivot
+    std::string deepPivotReal;
+    std::string deepPivotImag;
+
+    FractalType fractal = FractalType::Mandelbrot;
+
+    // c of FractalType::Julia and the exponent of FractalType::Multibrot, ignored by the other fractals
+    std::complex<double> juliaSeed;
+    int power = 3;
+
+    RenderMode mode = RenderMode::PerPixel;
+
+    // Skips iterating points inside the main cardioid or the period-2 bulb
+    bool bulbCheck = true;
+
+    // Orbits that come back within this fraction of a pixel of an earlier point are treated as
+    // periodic and stop iterating. 0 disables cycle detection
+    double periodTolerance = 1e-3;
+
+    // Colours by the normalized iteration count n + 1 - log_d(log|z_n| / log R) instead of n, which takes the bands
+    // out of the gradient. Smooth frames escape at |z|^2 = smoothBailout and keep a fraction per pixel next to the counts
+    bool smooth = false;
+
+    PaletteType palette = PaletteType::Greyscale;
+
+    // Iterations per trip through the palette, 0 stretches it once over the iteration limit
+    double paletteCycle = 0;
+
+    // Spreads the palette over the escaped pixels of the frame by their count histogram instead of over the counts,
+    // so views where most pixels escape within a narrow band still use every colour. Ignores paletteCycle
+    bool equalize = false;
+
+    // Levels of a HistogramEqualizer over the whole frame this request renders a part of. Equalized parts are then
+    // shaded with these instead of their own histogram, so they match where they meet. Not read by the GPU backend
+    const float *levels = nullptr;
+
+    // Jittered samples added to every edge pixel, whose colour becomes the average of them and its own. 0 turns the
+    // adaptive anti-aliasing off. Edge pixels are the ones whose count differs from one of their four neighbours by
+    // more than antialiasThreshold, or that border the interior
+    int antialias = 0;
+    int antialiasThreshold = 1;
+};
+
+// Squared escape radius of smooth frames, the normalized count is only continuous when it is far past the set
+const double smoothBailout = 65536;
+
+// Whether a and b iterate the same formula to the same escape radius, so escape counts of one can stand in for the other
+inline bool HasSameFractal(const RenderRequest &a, const RenderRequest &b) {
+    if (a.fractal != b.fractal || a.smooth != b.smooth) return false;
+    if (a.fractal == FractalType::Julia) return a.juliaSeed == b.juliaSeed;
+    if (a.fractal == FractalType::Multibrot) return a.power == b.power;
+
+    return true;
+}
+
+class Continuation;
+class IterationBuffer;
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    virtual const char *GetName() const = 0;
+
+    // Renders the request into image, resizing it as needed. Returns false on failure
+    virtual bool Render(const RenderRequest &request, sf::Image &image) = 0;
+
+    // Escape counts of the last frame, nullptr for backends that only produce pixels
+    virtual const IterationBuffer *GetIterations() const { return nullptr; }
+
+    // Shades the last frame again with the palette of request, which otherwise has to describe that same frame,
+    // without iterating anything. Returns false when the backend kept nothing to shade it from
+    virtual bool Recolor(const RenderRequest &request, sf::Image &image) { return false; }
+
+    // Per-pixel state that lets a higher iteration limit resume the last frame, nullptr when not kept
+    virtual Continuation *GetContinuation() { return nullptr; }
+
+    // CPU threads rendering a frame, 0 for backends that render off the CPU
+    virtual int GetThreadCount() const { return 1; }
+};
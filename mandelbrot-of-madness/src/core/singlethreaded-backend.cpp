@@ -0,0 +1,76 @@
+#include "core/singlethreaded-backend.hpp"
+#include "core/cpu-kernel.hpp"
+
+void SingleThreadedBackend::ReservePixels(int width, int height) {
+    size_t size = (size_t) width * height;
+
+    if (size > pixelsSize) {
+        pixels.reset(new uint8_t[size * 4]);
+        pixelsSize = size;
+    }
+}
+
+void SingleThreadedBackend::Shade(const RenderRequest &request) {
+    const uint32_t *counts = iterationBuffer.GetCounts();
+    const float *levels = nullptr;
+
+    if (request.equalize && request.levels) {
+        levels = request.levels;
+    } else if (request.equalize) {
+        equalizer.Build(counts, (size_t) request.width * request.height, request.iterations, nullptr);
+        levels = equalizer.GetLevels();
+    }
+
+    ShadeTile(counts, iterationBuffer.GetFractions(), request, levels, pixels.get(), request.width, 0, 0, request.width, request.height);
+    supersampler.Resolve(request, levels, pixels.get(), nullptr);
+}
+
+bool SingleThreadedBackend::Render(const RenderRequest &request, sf::Image &image) {
+    int width = request.width;
+    int height = request.height;
+
+    iterationBuffer.Reserve(width, height, request.smooth);
+    uint32_t *counts = iterationBuffer.GetCounts();
+    float *fractions = iterationBuffer.GetFractions();
+
+    ReservePixels(width, height);
+
+    // Subdivided and smooth frames keep no orbit state, as in the multithreaded backend
+    bool resume = keepContinuation && request.mode == RenderMode::PerPixel && !request.smooth;
+    if (resume && continuation.IsEmpty()) continuation.Reset(request);
+
+    int frameX = 0;
+    int frameY = 0;
+    resume = resume && continuation.Locate(request, frameX, frameY);
+
+    if (resume && (size_t) width * height > orbitsSize) {
+        orbitsSize = (size_t) width * height;
+        orbits.reset(new double[orbitsSize * 2]);
+    }
+
+    if (resume) CalculateContinuedTile(counts, orbits.get(), continuation, request, frameX, frameY, 0, 0, width, height);
+    else CalculateMandelbrotTile(counts, fractions, request, 0, 0, width, height);
+
+    supersampler.Sample(counts, request, nullptr, [&](int x, int y, double dx, double dy, float *fraction) {
+        std::complex<double> point = PixelToPoint(request, x, y) + std::complex<double>(dx, dy) / request.resolution;
+        return CalculateMandelbrotPoint(request, point.real(), point.imag(), fraction);
+    });
+
+    Shade(request);
+
+    image = sf::Image(sf::Vector2u(width, height), pixels.get());
+    return true;
+}
+
+bool SingleThreadedBackend::Recolor(const RenderRequest &request, sf::Image &image) {
+    if (!CanRecolor(iterationBuffer, request) || !supersampler.CanResolve(request)) return false;
+
+    int width = request.width;
+    int height = request.height;
+
+    ReservePixels(width, height);
+    Shade(request);
+
+    image = sf::Image(sf::Vector2u(width, height), pixels.get());
+    return true;
+}
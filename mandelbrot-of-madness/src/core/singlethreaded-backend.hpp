@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+
+#include "core/render.hpp"
+#include "core/iteration-buffer.hpp"
+#include "core/histogram.hpp"
+#include "core/supersample.hpp"
+#include "core/continuation.hpp"
+
+// Full for loops on the calling thread
+class SingleThreadedBackend : public RenderBackend {
+public:
+    // Keeps the orbit state of every pixel of RenderMode::PerPixel frames, like MultiThreadedOptions::keepContinuation
+    explicit SingleThreadedBackend(bool keepContinuation = false) : keepContinuation(keepContinuation) {}
+
+    const char *GetName() const override { return "Singlethreaded"; }
+
+    bool Render(const RenderRequest &request, sf::Image &image) override;
+    bool Recolor(const RenderRequest &request, sf::Image &image) override;
+
+    // Escape counts of the last frame
+    const IterationBuffer *GetIterations() const override { return &iterationBuffer; }
+
+    // Starts out empty and takes the first request as its frame, reset it to render another view
+    Continuation *GetContinuation() override { return keepContinuation ? &continuation : nullptr; }
+
+private:
+    // Colours the escape counts and edge samples of the last frame into pixels
+    void Shade(const RenderRequest &request);
+
+    // Grows pixels to hold width x height RGBA8 pixels, kept between frames
+    void ReservePixels(int width, int height);
+
+    IterationBuffer iterationBuffer;
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t pixelsSize = 0;
+    HistogramEqualizer equalizer;
+    EdgeSupersampler supersampler;
+
+    bool keepContinuation;
+    Continuation continuation;
+
+    // Last z of the pixels computed from scratch, before they are sorted into the continuation
+    std::unique_ptr<double[]> orbits;
+    size_t orbitsSize = 0;
+};
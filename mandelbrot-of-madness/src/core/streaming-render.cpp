@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <iostream>
+
+#include "core/streaming-render.hpp"
+#include "core/image-writer.hpp"
+#include "core/region-request.hpp"
+#include "core/histogram.hpp"
+#include "core/iteration-buffer.hpp"
+
+bool RenderStreaming(RenderBackend &backend, const RenderRequest &request, const std::string &filepath, int bandHeight) {
+    std::unique_ptr<RowWriter> writer = CreateRowWriter(filepath);
+    if (!writer) {
+        std::cout << "An error occured when trying to pick an encoder, streamed renders are saved as .png, .tif or .tiff!\n";
+        return false;
+    }
+
+    RenderRequest shaded = request;
+    HistogramEqualizer equalizer;
+    sf::Image band;
+
+    // Every band is shaded with the levels of the whole frame, whose histogram takes a first pass over the bands that
+    // only keeps their counts
+    if (request.equalize) {
+        RenderRequest counted = request;
+        counted.equalize = false;
+        counted.antialias = 0;
+
+        equalizer.Clear(request.iterations);
+
+        for (int y = 0; y < request.height; y += bandHeight) {
+            int rows = std::min(bandHeight, request.height - y);
+
+            if (!backend.Render(RegionRequest(counted, 0, y, request.width, rows), band)) {
+                std::cout << "An error occured when trying to render rows " << y << " to " << y + rows << "!\n";
+                return false;
+            }
+
+            if (!backend.GetIterations()) {
+                std::cout << "An error occured when trying to equalize, " << backend.GetName() << " keeps no escape counts to stream from!\n";
+                return false;
+            }
+
+            equalizer.Add(backend.GetIterations()->GetCounts(), (size_t) request.width * rows);
+        }
+
+        equalizer.BuildAdded();
+        shaded.levels = equalizer.GetLevels();
+    }
+
+    if (!writer->Open(filepath, request.width, request.height)) return false;
+
+    // Anti-aliased bands take a row of their neighbours on either side, so pixels on the border rows see all four
+    // neighbours when edges are found. Only the band's own rows are written
+    int overlap = request.antialias > 0 ? 1 : 0;
+
+    for (int y = 0; y < request.height; y += bandHeight) {
+        int rows = std::min(bandHeight, request.height - y);
+        int above = std::min(overlap, y);
+        int below = std::min(overlap, request.height - y - rows);
+
+        if (!backend.Render(RegionRequest(shaded, 0, y - above, request.width, above + rows + below), band)) {
+            std::cout << "An error occured when trying to render rows " << y << " to " << y + rows << "!\n";
+            return false;
+        }
+
+        if (!writer->WriteRows(band.getPixelsPtr() + (size_t) above * request.width * 4, rows)) return false;
+    }
+
+    return writer->Close();
+}
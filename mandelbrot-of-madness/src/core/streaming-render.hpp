@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+#include "core/render.hpp"
+
+// Rows rendered at a time by RenderStreaming
+const int defaultBandHeight = 256;
+
+// Frames with more pixels than this are streamed by RenderToFile instead of being held in one sf::Image
+const long long streamingPixelThreshold = 64ll * 1024 * 1024;
+
+// Renders request in horizontal bands of bandHeight rows and passes each band to a PNG or TIFF encoder, picked
+// from the extension of filepath, as soon as it's done. Backend buffers only ever hold one band, so peak memory
+// is bounded by width * bandHeight rather than by the image size. Equalized frames are rendered twice, the first pass
+// only counts the escape counts of every band, so it needs a backend that keeps them
+bool RenderStreaming(RenderBackend &backend, const RenderRequest &request, const std::string &filepath, int bandHeight = defaultBandHeight);
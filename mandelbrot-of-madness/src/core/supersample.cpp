@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "core/supersample.hpp"
+#include "core/cpu-kernel.hpp"
+
+// Edges a thread takes off the list at a time
+const size_t edgeChunk = 64;
+
+void GetSampleOffset(uint32_t pixel, int sample, double &dx, double &dy) {
+    uint32_t hash = pixel * 0x9E3779B9u;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    hash *= 0x846CA68Bu;
+    hash ^= hash >> 16;
+
+    // Steps of the plastic number spread any number of samples evenly over the pixel
+    double x = (hash & 0xFFFF) / 65536.0 + 0.7548776662 * (sample + 1);
+    double y = (hash >> 16) / 65536.0 + 0.5698402910 * (sample + 1);
+
+    dx = x - std::floor(x) - 0.5;
+    dy = y - std::floor(y) - 0.5;
+}
+
+static bool IsEdge(const uint32_t *counts, uint32_t limit, uint32_t threshold, size_t pixel, size_t neighbour) {
+    uint32_t count = counts[pixel];
+    uint32_t other = counts[neighbour];
+
+    if ((count >= limit) != (other >= limit)) return true;
+    return (count > other ? count - other : other - count) > threshold;
+}
+
+void EdgeSupersampler::Sample(const uint32_t *counts, const RenderRequest &request, ThreadPool *pool, const PointSampler &sampler) {
+    edges.clear();
+    samples = request.antialias;
+    threshold = request.antialiasThreshold;
+
+    if (samples <= 0) return;
+
+    int width = request.width;
+    int height = request.height;
+    int threadcount = pool ? pool->GetThreadCount() : 1;
+    uint32_t limit = request.iterations;
+
+    auto runOnAll = [&](const ThreadPool::Job &job) {
+        if (pool) pool->RunOnAll(job);
+        else job(0);
+    };
+
+    bandEdges.resize(threadcount);
+
+    runOnAll([&](int thread) {
+        std::vector<uint32_t> &band = bandEdges[thread];
+        band.clear();
+
+        for (int y = height * thread / threadcount; y < height * (thread + 1) / threadcount; y++) {
+            for (int x = 0; x < width; x++) {
+                size_t i = (size_t) y * width + x;
+
+                bool edge = (x > 0 && IsEdge(counts, limit, threshold, i, i - 1)) || (x + 1 < width && IsEdge(counts, limit, threshold, i, i + 1)) ||
+                            (y > 0 && IsEdge(counts, limit, threshold, i, i - width)) || (y + 1 < height && IsEdge(counts, limit, threshold, i, i + width));
+
+                if (edge) band.push_back(i);
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const std::vector<uint32_t> &band : bandEdges) total += band.size();
+
+    edges.resize(total);
+    sampleCounts.resize(total * samples);
+    if (request.smooth) sampleFractions.resize(total * samples);
+
+    // Compacts the bands in order, each thread copies its own
+    runOnAll([&](int thread) {
+        size_t offset = 0;
+        for (int other = 0; other < thread; other++) offset += bandEdges[other].size();
+
+        std::copy(bandEdges[thread].begin(), bandEdges[thread].end(), edges.begin() + offset);
+    });
+
+    std::atomic<size_t> next(0);
+
+    runOnAll([&](int thread) {
+        for (size_t first = next.fetch_add(edgeChunk); first < total; first = next.fetch_add(edgeChunk)) {
+            for (size_t e = first; e < std::min(first + edgeChunk, total); e++) {
+                int x = edges[e] % width;
+                int y = edges[e] / width;
+
+                for (int k = 0; k < samples; k++) {
+                    double dx, dy;
+                    GetSampleOffset(edges[e], k, dx, dy);
+
+                    size_t s = e * samples + k;
+                    sampleCounts[s] = sampler(x, y, dx, dy, request.smooth ? &sampleFractions[s] : nullptr);
+                }
+            }
+        }
+    });
+}
+
+void EdgeSupersampler::Resolve(const RenderRequest &request, const float *levels, uint8_t *pixels, ThreadPool *pool) {
+    if (request.antialias <= 0 || edges.empty()) return;
+
+    int threadcount = pool ? pool->GetThreadCount() : 1;
+    size_t total = edges.size();
+
+    auto resolve = [&](int thread) {
+        std::vector<uint8_t> colours((size_t) samples * 4);
+
+        for (size_t e = total * thread / threadcount; e < total * (thread + 1) / threadcount; e++) {
+            size_t s = e * samples;
+
+            // The samples of one edge are a row of their own as far as the colouring pass knows
+            ShadeTile(&sampleCounts[s], request.smooth ? &sampleFractions[s] : nullptr, request, levels, colours.data(), samples, 0, 0, samples, 1);
+
+            uint8_t *pixel = pixels + (size_t) edges[e] * 4;
+
+            for (int channel = 0; channel < 4; channel++) {
+                int sum = pixel[channel];
+                for (int k = 0; k < samples; k++) sum += colours[k * 4 + channel];
+
+                pixel[channel] = (sum + (samples + 1) / 2) / (samples + 1);
+            }
+        }
+    };
+
+    if (pool) pool->RunOnAll(resolve);
+    else resolve(0);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/render.hpp"
+#include "core/thread-pool.hpp"
+
+// Escape count of the point dx, dy pixels away from pixel (x, y) of the frame, and its smooth fraction when fraction
+// isn't null. Every backend samples with its own arithmetic
+typedef std::function<uint32_t(int x, int y, double dx, double dy, float *fraction)> PointSampler;
+
+// Jittered offset of sample k of the pixel at index pixel of the row-major frame, within half a pixel of it on both
+// axes. A rank-1 lattice rotated by a hash of the pixel, the same sequence as the OpenCL kernels
+void GetSampleOffset(uint32_t pixel, int sample, double &dx, double &dy);
+
+// Adaptive anti-aliasing, see RenderRequest::antialias. Every thread looks for edges in its own band of rows, the
+// bands are compacted into one list and the threads take the edges off it in small chunks, since they bunch up
+// along the boundary. Samples are kept, so the frame can be coloured again without sampling
+class EdgeSupersampler {
+public:
+    // Finds the edges of the counts of request's frame and samples them on pool, or on the calling thread when pool
+    // is null. Drops the samples of the last frame when request has no anti-aliasing
+    void Sample(const uint32_t *counts, const RenderRequest &request, ThreadPool *pool, const PointSampler &sampler);
+
+    // Blends the samples into the edge pixels, which must already hold their own colour. Samples are coloured like
+    // ShadeTile colours the frame with levels
+    void Resolve(const RenderRequest &request, const float *levels, uint8_t *pixels, ThreadPool *pool);
+
+    // Whether the samples of the last frame are the ones request asks for
+    bool CanResolve(const RenderRequest &request) const {
+        return request.antialias == 0 || (request.antialias == samples && request.antialiasThreshold == threshold);
+    }
+
+    // Edge pixels of the last frame
+    size_t GetEdgeCount() const { return edges.size(); }
+
+private:
+    std::vector<std::vector<uint32_t>> bandEdges;
+    std::vector<uint32_t> edges;
+
+    // samples entries per edge
+    std::vector<uint32_t> sampleCounts;
+    std::vector<float> sampleFractions;
+    int samples = 0;
+    int threshold = 0;
+};
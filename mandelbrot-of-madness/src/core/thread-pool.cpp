@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "core/thread-pool.hpp"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static bool PinThread(std::thread &thread, int core) {
+#if defined(_WIN32)
+    return SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR) 1 << (core % (sizeof(DWORD_PTR) * 8))) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+ThreadPool::ThreadPool(int threadcount, bool pinThreads) : pinned(pinThreads) {
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+
+    if (threadcount <= 0) {
+        threadcount = cores;
+    }
+
+    for (int t = 0; t < threadcount; t++) {
+        threads.emplace_back(&ThreadPool::Worker, this, t);
+
+        if (pinThreads && !PinThread(threads.back(), t % cores)) {
+            pinned = false;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::RunOnAll(const Job &job) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    this->job = &job;
+    running = threads.size();
+    generation++;
+
+    wake.notify_all();
+    done.wait(lock, [this] { return running == 0; });
+
+    this->job = nullptr;
+}
+
+void ThreadPool::Worker(int thread) {
+    unsigned long long seen = 0;
+
+    while (true) {
+        const Job *current;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+
+            if (stopping) return;
+
+            seen = generation;
+            current = job;
+        }
+
+        (*current)(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--running == 0) {
+            done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Long-lived workers that every frame is submitted to, so renders don't pay for thread creation
+class ThreadPool {
+public:
+    typedef std::function<void(int thread)> Job;
+
+    // A threadcount of 0 uses every hardware thread. Pinned workers are bound to one core each
+    explicit ThreadPool(int threadcount = 0, bool pinThreads = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int GetThreadCount() const { return threads.size(); }
+    bool IsPinned() const { return pinned; }
+
+    // Runs job once on every worker, passing its index, and blocks until all of them return
+    void RunOnAll(const Job &job);
+
+private:
+    void Worker(int thread);
+
+    std::vector<std::thread> threads;
+    bool pinned;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const Job *job = nullptr;
+    unsigned long long generation = 0;
+    int running = 0;
+    bool stopping = false;
+};
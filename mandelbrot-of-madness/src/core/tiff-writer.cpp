@@ -0,0 +1,184 @@
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "core/image-writer.hpp"
+
+// Field types used in the directory, and their size in bytes
+static const uint16_t tiffShort = 3;
+static const uint16_t tiffLong = 4;
+static const uint16_t tiffLong8 = 16;
+
+static int TypeSize(uint16_t type) {
+    return type == tiffShort ? 2 : type == tiffLong ? 4 : 8;
+}
+
+struct TiffEntry {
+    uint16_t tag;
+    uint16_t type;
+    std::vector<uint64_t> values;
+};
+
+struct TiffRowWriter::State {
+    std::ofstream file;
+    uint64_t position = 0;
+    int width = 0;
+    int height = 0;
+
+    // BigTIFF has 64-bit offsets, 8 byte value fields and 20 byte directory entries
+    bool big = false;
+
+    std::vector<uint64_t> stripOffsets;
+    std::vector<uint8_t> row;
+
+    void Write(const void *data, size_t size) {
+        file.write((const char *) data, size);
+        position += size;
+    }
+
+    void WriteInteger(uint64_t value, int size) {
+        uint8_t bytes[8];
+
+        for (int i = 0; i < size; i++) {
+            bytes[i] = value >> (8 * i);
+        }
+
+        Write(bytes, size);
+    }
+
+    void Align() {
+        if (position % 2) WriteInteger(0, 1);
+    }
+};
+
+TiffRowWriter::TiffRowWriter() = default;
+
+TiffRowWriter::~TiffRowWriter() = default;
+
+bool TiffRowWriter::Open(const std::string &filepath, int width, int height) {
+    state.reset(new State());
+    state->width = width;
+    state->height = height;
+    state->row.resize((size_t) width * 3);
+    state->stripOffsets.reserve(height);
+
+    // Pixel data plus the two per-strip arrays and some room for the directory
+    uint64_t estimate = (uint64_t) width * height * 3 + (uint64_t) height * 16 + 4096;
+    state->big = estimate > 0xFFFFFFFFull;
+
+    state->file.open(filepath, std::ios::binary);
+    if (!state->file) {
+        std::cout << "An error occured when trying to open " << filepath << "!\n";
+        return false;
+    }
+
+    // Little endian header, the directory offset is patched in by Close
+    state->Write("II", 2);
+
+    if (state->big) {
+        state->WriteInteger(43, 2);
+        state->WriteInteger(8, 2);
+        state->WriteInteger(0, 2);
+        state->WriteInteger(0, 8);
+    } else {
+        state->WriteInteger(42, 2);
+        state->WriteInteger(0, 4);
+    }
+
+    return true;
+}
+
+bool TiffRowWriter::WriteRows(const uint8_t *pixels, int rows) {
+    for (int y = 0; y < rows; y++) {
+        const uint8_t *in = pixels + (size_t) y * state->width * 4;
+
+        for (int x = 0; x < state->width; x++) {
+            state->row[x * 3 + 0] = in[x * 4 + 0];
+            state->row[x * 3 + 1] = in[x * 4 + 1];
+            state->row[x * 3 + 2] = in[x * 4 + 2];
+        }
+
+        state->stripOffsets.push_back(state->position);
+        state->Write(state->row.data(), state->row.size());
+    }
+
+    if (!state->file) {
+        std::cout << "An error occured when trying to write tiff rows!\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool TiffRowWriter::Close() {
+    uint16_t offsetType = state->big ? tiffLong8 : tiffLong;
+    uint64_t stripSize = state->row.size();
+
+    // Sorted by tag, as the format requires
+    std::vector<TiffEntry> entries = {
+        {256, tiffLong, {(uint64_t) state->width}},
+        {257, tiffLong, {(uint64_t) state->height}},
+        {258, tiffShort, {8, 8, 8}},
+        {259, tiffShort, {1}},
+        {262, tiffShort, {2}},
+        {273, offsetType, state->stripOffsets},
+        {277, tiffShort, {3}},
+        {278, tiffLong, {1}},
+        {279, offsetType, std::vector<uint64_t>(state->stripOffsets.size(), stripSize)},
+        {284, tiffShort, {1}}
+    };
+
+    int fieldSize = state->big ? 8 : 4;
+
+    // Values that don't fit in an entry are written ahead of the directory and referenced by offset
+    std::vector<uint64_t> fields;
+
+    for (const TiffEntry &entry : entries) {
+        int size = TypeSize(entry.type);
+
+        if (entry.values.size() * size <= (size_t) fieldSize) {
+            uint64_t packed = 0;
+
+            for (size_t i = 0; i < entry.values.size(); i++) {
+                packed |= entry.values[i] << (8 * size * i);
+            }
+
+            fields.push_back(packed);
+            continue;
+        }
+
+        state->Align();
+        fields.push_back(state->position);
+
+        for (uint64_t value : entry.values) {
+            state->WriteInteger(value, size);
+        }
+    }
+
+    state->Align();
+    uint64_t directory = state->position;
+
+    state->WriteInteger(entries.size(), state->big ? 8 : 2);
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        state->WriteInteger(entries[i].tag, 2);
+        state->WriteInteger(entries[i].type, 2);
+        state->WriteInteger(entries[i].values.size(), fieldSize);
+        state->WriteInteger(fields[i], fieldSize);
+    }
+
+    // No further directories
+    state->WriteInteger(0, fieldSize);
+
+    state->file.seekp(state->big ? 8 : 4);
+    state->WriteInteger(directory, fieldSize);
+
+    state->file.close();
+
+    if (!state->file) {
+        std::cout << "An error occured when trying to finish tiff!\n";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "core/tile-cache.hpp"
+
+// 64-bit FNV-1a, only used to name spill directories
+static uint64_t HashString(const std::string &text) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+TileCache::TileCache(size_t capacity, const std::string &spillDirectory) : capacity(std::max<size_t>(capacity, 1)), spillDirectory(spillDirectory) {
+
+}
+
+TileCache::~TileCache() {
+    Flush();
+}
+
+void TileCache::SetParameters(const RenderRequest &request) {
+    if (hasParameters && request.iterations == parameters.iterations && HasSameFractal(request, parameters) && request.mode == parameters.mode &&
+        request.bulbCheck == parameters.bulbCheck && request.periodTolerance == parameters.periodTolerance) return;
+
+    // Whatever is in memory belongs to the old parameters, it's only worth keeping on disk
+    Flush();
+    tiles.clear();
+    index.clear();
+
+    parameters = request;
+    hasParameters = true;
+
+    if (spillDirectory.empty()) return;
+
+    std::ostringstream description;
+    description << "iterations " << request.iterations << " fractal " << (int) request.fractal << " mode " << (int) request.mode;
+    if (request.fractal == FractalType::Julia) description << " seed " << std::setprecision(17) << request.juliaSeed.real() << " " << request.juliaSeed.imag();
+    if (request.fractal == FractalType::Multibrot) description << " power " << request.power;
+    if (request.smooth) description << " smooth";
+    description << " bulb " << request.bulbCheck << " tolerance " << std::setprecision(17) << request.periodTolerance << " tile " << tileSize;
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << HashString(description.str());
+
+    parameterDirectory = (std::filesystem::path(spillDirectory) / name.str()).string();
+
+    std::error_code ignored;
+    std::filesystem::create_directories(parameterDirectory, ignored);
+}
+
+std::string TileCache::GetSpillPath(const TileKey &key) const {
+    std::ostringstream name;
+    name << key.level << "_" << key.x << "_" << key.y << ".tile";
+
+    return (std::filesystem::path(parameterDirectory) / name.str()).string();
+}
+
+void TileCache::Spill(Entry &entry) {
+    if (spillDirectory.empty() || entry.spilled) return;
+
+    std::ofstream file(GetSpillPath(entry.key), std::ios::binary);
+    file.write((const char *) entry.tile->data(), entry.tile->size() * sizeof(uint32_t));
+
+    entry.spilled = (bool) file;
+}
+
+TileData TileCache::Find(const TileKey &key) {
+    auto found = index.find(key);
+
+    if (found != index.end()) {
+        tiles.splice(tiles.begin(), tiles, found->second);
+        hits++;
+        return found->second->tile;
+    }
+
+    if (!spillDirectory.empty()) {
+        std::ifstream file(GetSpillPath(key), std::ios::binary);
+
+        if (file) {
+            std::shared_ptr<std::vector<uint32_t>> tile = std::make_shared<std::vector<uint32_t>>(GetTileWords());
+
+            if (file.read((char *) tile->data(), tile->size() * sizeof(uint32_t))) {
+                diskHits++;
+                Insert(key, tile);
+                tiles.front().spilled = true;
+                return tile;
+            }
+        }
+    }
+
+    misses++;
+    return nullptr;
+}
+
+void TileCache::Insert(const TileKey &key, const TileData &tile) {
+    auto found = index.find(key);
+
+    if (found != index.end()) {
+        found->second->tile = tile;
+        found->second->spilled = false;
+        tiles.splice(tiles.begin(), tiles, found->second);
+        return;
+    }
+
+    tiles.push_front(Entry {key, tile, false});
+    index[key] = tiles.begin();
+
+    while (tiles.size() > capacity) {
+        Spill(tiles.back());
+        index.erase(tiles.back().key);
+        tiles.pop_back();
+    }
+}
+
+void TileCache::Flush() {
+    for (Entry &entry : tiles) {
+        Spill(entry);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/render.hpp"
+
+// Pixels per side of a tile
+const int tileSize = 128;
+
+// Level n holds the frames rendered at a resolution of 2^n. Past this the tile coordinates and pivots stop being
+// exact in a double, so deeper frames are rendered without tiles
+const int maxTileLevel = 50;
+
+// Tile (level, x, y) covers the points (x * tileSize + i, y * tileSize + j) / 2^level for i, j in [0, tileSize)
+struct TileKey {
+    int level = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+
+    bool operator==(const TileKey &other) const { return level == other.level && x == other.x && y == other.y; }
+};
+
+struct TileKeyHash {
+    size_t operator()(const TileKey &key) const {
+        uint64_t hash = (uint64_t) key.x * 0x9E3779B97F4A7C15ull;
+        hash ^= (uint64_t) key.y * 0xC2B2AE3D27D4EB4Full + (hash << 6) + (hash >> 2);
+        return hash ^ (uint64_t) key.level;
+    }
+};
+
+// Escape counts of one tile, tileSize rows of tileSize, with rows going up the imaginary axis like every frame.
+// Tiles of smooth frames are followed by as many fractions, stored as the bits of each float
+typedef std::shared_ptr<const std::vector<uint32_t>> TileData;
+
+// Least recently used tiles of escape counts. Tiles pushed out of memory are written to the spill directory, when
+// there is one, and read back from it on a later miss, so the pyramid also survives between runs
+class TileCache {
+public:
+    explicit TileCache(size_t capacity = 1024, const std::string &spillDirectory = "");
+    ~TileCache();
+
+    TileCache(const TileCache &) = delete;
+    TileCache &operator=(const TileCache &) = delete;
+
+    // Tiles hold everything but the view, so a request with another iteration limit, fractal or cycle tolerance
+    // drops the tiles in memory. Spilled tiles are kept apart per set of parameters
+    void SetParameters(const RenderRequest &request);
+
+    // nullptr when the tile is neither in memory nor spilled
+    TileData Find(const TileKey &key);
+    void Insert(const TileKey &key, const TileData &tile);
+
+    // Writes every tile in memory to the spill directory
+    void Flush();
+
+    // Words per tile for the current parameters, counts and fractions for smooth frames
+    size_t GetTileWords() const { return (size_t) tileSize * tileSize * (parameters.smooth ? 2 : 1); }
+
+    size_t GetSize() const { return tiles.size(); }
+    size_t GetCapacity() const { return capacity; }
+
+    long long GetHits() const { return hits; }
+    long long GetDiskHits() const { return diskHits; }
+    long long GetMisses() const { return misses; }
+
+private:
+    struct Entry {
+        TileKey key;
+        TileData tile;
+        bool spilled;
+    };
+
+    std::string GetSpillPath(const TileKey &key) const;
+    void Spill(Entry &entry);
+
+    size_t capacity;
+    std::string spillDirectory;
+
+    // Subdirectory of the spill directory for the current parameters
+    std::string parameterDirectory;
+    RenderRequest parameters;
+    bool hasParameters = false;
+
+    // Front is the most recently used
+    std::list<Entry> tiles;
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> index;
+
+    long long hits = 0;
+    long long diskHits = 0;
+    long long misses = 0;
+};
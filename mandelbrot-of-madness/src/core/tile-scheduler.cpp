@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+
+#include "core/tile-scheduler.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static double NowMs() {
+    return std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch()).count();
+}
+
+void TileScheduler::Run(int width, int height, int tileSize, ThreadPool &pool, const TileWork &work) {
+    int threadcount = pool.GetThreadCount();
+    tileSize = std::max(1, tileSize);
+
+    std::vector<Tile> tiles;
+    for (int y = 0; y < height; y += tileSize) {
+        for (int x = 0; x < width; x += tileSize) {
+            tiles.push_back(Tile{x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)});
+        }
+    }
+
+    queues = std::vector<WorkQueue>(threadcount);
+    stats.assign(threadcount, ThreadStats());
+
+    // Contiguous shares keep neighbouring tiles on the same core until stealing kicks in
+    for (int t = 0; t < threadcount; t++) {
+        size_t from = tiles.size() * t / threadcount;
+        size_t to = tiles.size() * (t + 1) / threadcount;
+
+        queues[t].tiles.assign(tiles.begin() + from, tiles.begin() + to);
+    }
+
+    double frameStart = NowMs();
+
+    pool.RunOnAll([&](int thread) {
+        Worker(thread, work);
+    });
+
+    double frameTime = NowMs() - frameStart;
+
+    for (ThreadStats &stat : stats) {
+        stat.idleMs = std::max(0.0, frameTime - stat.busyMs);
+    }
+}
+
+bool TileScheduler::PopLocal(int thread, Tile &tile) {
+    WorkQueue &queue = queues[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tiles.empty()) return false;
+
+    tile = queue.tiles.front();
+    queue.tiles.pop_front();
+    return true;
+}
+
+bool TileScheduler::Steal(int thread, Tile &tile) {
+    int threadcount = queues.size();
+
+    // Take from the far end of the victim's share so the owner keeps working on its cache-warm rows
+    for (int i = 1; i < threadcount; i++) {
+        WorkQueue &queue = queues[(thread + i) % threadcount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tiles.empty()) continue;
+
+        tile = queue.tiles.back();
+        queue.tiles.pop_back();
+        return true;
+    }
+
+    return false;
+}
+
+void TileScheduler::Worker(int thread, const TileWork &work) {
+    ThreadStats &stat = stats[thread];
+    Tile tile;
+
+    while (true) {
+        bool stolen = false;
+
+        if (!PopLocal(thread, tile)) {
+            if (!Steal(thread, tile)) break;
+            stolen = true;
+        }
+
+        double start = NowMs();
+        work(tile);
+        stat.busyMs += NowMs() - start;
+
+        stat.tiles++;
+        if (stolen) stat.stolen++;
+    }
+}
+
+void PrintThreadStats(std::ostream &out, const std::vector<ThreadStats> &stats) {
+    for (size_t t = 0; t < stats.size(); t++) {
+        out << "Thread " << t << " : busy " << stats[t].busyMs << "ms, idle " << stats[t].idleMs << "ms, ";
+        out << stats[t].tiles << " tiles (" << stats[t].stolen << " stolen)\n";
+    }
+}
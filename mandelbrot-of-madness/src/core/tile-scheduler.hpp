@@ -0,0 +1,50 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "core/thread-pool.hpp"
+
+struct Tile {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+struct ThreadStats {
+    double busyMs = 0;
+    double idleMs = 0;
+    int tiles = 0;
+    int stolen = 0;
+};
+
+// Splits a frame into small square tiles and runs them on a thread pool. Every thread starts
+// with a contiguous share of the tiles in its own deque and steals from the others once it runs dry
+class TileScheduler {
+public:
+    typedef std::function<void(const Tile &tile)> TileWork;
+
+    void Run(int width, int height, int tileSize, ThreadPool &pool, const TileWork &work);
+
+    // Per-thread timings of the last Run
+    const std::vector<ThreadStats> &GetStats() const { return stats; }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Tile> tiles;
+    };
+
+    bool PopLocal(int thread, Tile &tile);
+    bool Steal(int thread, Tile &tile);
+    void Worker(int thread, const TileWork &work);
+
+    std::vector<WorkQueue> queues;
+    std::vector<ThreadStats> stats;
+};
+
+void PrintThreadStats(std::ostream &out, const std::vector<ThreadStats> &stats);
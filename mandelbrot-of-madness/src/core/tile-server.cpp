@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include <SFML/Network/TcpListener.hpp>
+#include <SFML/System/Time.hpp>
+
+#include "core/tile-server.hpp"
+#include "core/double-float.hpp"
+#include "core/image-writer.hpp"
+#include "core/palette.hpp"
+
+// Connections beyond this are closed right after accepting them
+const int maxConnections = 512;
+
+// Idle keep-alive connections are closed after this long
+const float keepAliveSeconds = 30.0f;
+
+// Requests with a longer head are dropped
+const size_t maxRequestHeadBytes = 8192;
+
+// Map at / for trying the server out in a browser
+const char viewerPage[] = R"(<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<title>Mandelbrot Of Madness</title>
+<link rel="stylesheet" href="https://unpkg.com/leaflet@1.9.4/dist/leaflet.css">
+<script src="https://unpkg.com/leaflet@1.9.4/dist/leaflet.js"></script>
+<style>html, body, #map { height: 100%; margin: 0; background: #000; }</style>
+</head>
+<body>
+<div id="map"></div>
+<script>
+var map = L.map("map", {crs: L.CRS.Simple, minZoom: 0, maxZoom: 40, zoomSnap: 1}).setView([-128, 128], 1);
+L.tileLayer("/{z}/{x}/{y}.png" + location.search, {
+    tileSize: 256, noWrap: true, maxNativeZoom: 40, bounds: [[-256, 0], [0, 256]]
+}).addTo(map);
+</script>
+</body>
+</html>
+)";
+
+TileServer::TileServer(RenderBackend &backend, RenderBackend &deepBackend, const TileServerOptions &options) :
+    options(options), cache(1024, options.spillDirectory), shallowTiler(backend, cache), deepTiler(deepBackend, cache) {
+    renderThread = std::thread(&TileServer::RenderLoop, this);
+}
+
+TileServer::~TileServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    renderThread.join();
+
+    // Whoever is still waiting gets nothing
+    for (const std::shared_ptr<Pending> &pending : queue) pending->promise.set_value(nullptr);
+    queue.clear();
+    inFlight.clear();
+
+    // Connections notice stopping within a second of waiting for their next request
+    for (auto &connection : connectionThreads) connection.second.join();
+}
+
+void TileServer::JoinFinishedConnections() {
+    std::vector<std::thread::id> finished;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(finishedConnections);
+    }
+
+    for (std::thread::id id : finished) {
+        auto found = connectionThreads.find(id);
+        found->second.join();
+        connectionThreads.erase(found);
+    }
+}
+
+static std::string GetTileKey(const WebTile &tile) {
+    std::ostringstream key;
+    key.precision(17);
+    key << tile.zoom << "/" << tile.x << "/" << tile.y << "/" << tile.iterations << "/" << (int) tile.fractal;
+
+    if (tile.fractal == FractalType::Julia) key << "/" << tile.juliaSeed.real() << "/" << tile.juliaSeed.imag();
+    if (tile.fractal == FractalType::Multibrot) key << "/" << tile.power;
+
+    key << "/" << tile.smooth << "/" << (int) tile.palette << "/" << tile.paletteCycle;
+
+    return key.str();
+}
+
+bool TileServer::IsLowerPriority(const std::shared_ptr<Pending> &a, const std::shared_ptr<Pending> &b) const {
+    bool aShown = a->tile.zoom == latestZoom;
+    bool bShown = b->tile.zoom == latestZoom;
+
+    if (aShown != bShown) return bShown;
+    return a->sequence < b->sequence;
+}
+
+EncodedTile TileServer::GetTile(const WebTile &tile) {
+    std::string key = GetTileKey(tile);
+    std::shared_future<EncodedTile> result;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Nothing renders it anymore
+        if (stopping) return nullptr;
+
+        requests++;
+
+        auto cached = responseIndex.find(key);
+
+        if (cached != responseIndex.end()) {
+            responses.splice(responses.begin(), responses, cached->second);
+            responseHits++;
+            return cached->second->second;
+        }
+
+        latestZoom = tile.zoom;
+
+        auto found = inFlight.find(key);
+
+        if (found != inFlight.end()) {
+            // Asked for again, so it's still wanted
+            found->second->sequence = ++sequence;
+            coalesced++;
+            result = found->second->result;
+        } else {
+            std::shared_ptr<Pending> pending = std::make_shared<Pending>();
+            pending->tile = tile;
+            pending->key = key;
+            pending->sequence = ++sequence;
+            pending->result = pending->promise.get_future().share();
+
+            result = pending->result;
+
+            queue.push_back(pending);
+            inFlight[key] = pending;
+
+            if (queue.size() > options.queueCapacity) {
+                auto lowest = std::min_element(queue.begin(), queue.end(), [&](const std::shared_ptr<Pending> &a, const std::shared_ptr<Pending> &b) {
+                    return IsLowerPriority(a, b);
+                });
+
+                (*lowest)->promise.set_value(nullptr);
+                inFlight.erase((*lowest)->key);
+                queue.erase(lowest);
+                dropped++;
+            }
+
+            wake.notify_one();
+        }
+    }
+
+    return result.get();
+}
+
+void TileServer::RenderLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        if (queue.empty()) {
+            wake.wait(lock);
+            continue;
+        }
+
+        auto highest = std::max_element(queue.begin(), queue.end(), [&](const std::shared_ptr<Pending> &a, const std::shared_ptr<Pending> &b) {
+            return IsLowerPriority(a, b);
+        });
+
+        std::shared_ptr<Pending> pending = *highest;
+        queue.erase(highest);
+
+        lock.unlock();
+
+        EncodedTile encoded;
+        if (!RenderTile(pending->tile, encoded)) encoded = nullptr;
+
+        lock.lock();
+
+        if (encoded) {
+            responses.emplace_front(pending->key, encoded);
+            responseIndex[pending->key] = responses.begin();
+
+            while (responses.size() > options.responseCapacity) {
+                responseIndex.erase(responses.back().first);
+                responses.pop_back();
+            }
+
+            rendered++;
+        }
+
+        inFlight.erase(pending->key);
+        pending->promise.set_value(encoded);
+    }
+}
+
+bool TileServer::RenderTile(const WebTile &tile, EncodedTile &encoded) {
+    RenderRequest request;
+    request.width = webTileSize;
+    request.height = webTileSize;
+    request.resolution = std::ldexp(1.0, tile.zoom + webTileLevelOffset);
+    request.iterations = tile.iterations;
+    request.fractal = tile.fractal;
+    request.juliaSeed = tile.juliaSeed;
+    request.power = tile.power;
+    request.smooth = tile.smooth;
+    request.palette = tile.palette;
+    request.paletteCycle = tile.paletteCycle;
+
+    // Tile x goes right from -2 and tile y goes down from 2i, the center of each is (2k + 1) * 2^(1 - zoom) away
+    double centerX = std::ldexp(2.0 * tile.x + 1.0, 1 - tile.zoom);
+    double centerY = std::ldexp(2.0 * tile.y + 1.0, 1 - tile.zoom);
+    request.pivot = std::complex<double>(centerX - 2.0, 2.0 - centerY);
+
+    TiledBackend &tiler = request.resolution > doubleFloatPrecisionResolution ? deepTiler : shallowTiler;
+    if (!tiler.Render(request, image)) return false;
+
+    // Frames go up the imaginary axis, maps go down
+    std::shared_ptr<std::vector<uint8_t>> png = std::make_shared<std::vector<uint8_t>>();
+    if (!EncodePng(image.getPixelsPtr(), webTileSize, webTileSize, true, *png)) return false;
+
+    encoded = png;
+    return true;
+}
+
+std::string TileServer::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostringstream stats;
+
+    stats << "{\"connections\": " << connections << ", \"requests\": " << requests << ", \"responseHits\": " << responseHits;
+    stats << ", \"coalesced\": " << coalesced << ", \"rendered\": " << rendered << ", \"dropped\": " << dropped;
+    stats << ", \"queued\": " << queue.size() << ", \"cachedTiles\": " << responses.size() << "}\n";
+
+    return stats.str();
+}
+
+// Reads /z/x/y.png with optional ?iterations=N, fractal=julia|multibrot|burning-ship, re=X&im=Y for the Julia seed
+// and power=N for the multibrot, and smooth=1, palette=NAME and cycle=N for the colouring. Returns the HTTP status
+// for the request, 200 when tile is valid
+static int ParseTileTarget(const std::string &target, const TileServerOptions &options, WebTile &tile) {
+    size_t question = target.find('?');
+    std::string path = target.substr(0, question);
+    std::string query = question == std::string::npos ? "" : target.substr(question + 1);
+
+    char slash1, slash2, slash3;
+    std::string extension;
+    std::istringstream stream(path);
+
+    if (!(stream >> slash1 >> tile.zoom >> slash2 >> tile.x >> slash3 >> tile.y >> extension) || slash1 != '/' || slash2 != '/' || slash3 != '/' || extension != ".png") return 404;
+
+    if (tile.zoom < 0 || tile.zoom > maxWebZoom) return 404;
+
+    int64_t tiles = (int64_t) 1 << tile.zoom;
+    if (tile.x < 0 || tile.y < 0 || tile.x >= tiles || tile.y >= tiles) return 404;
+
+    tile.iterations = options.defaultIterations;
+
+    std::istringstream parameters(query);
+    std::string parameter;
+
+    while (std::getline(parameters, parameter, '&')) {
+        size_t equals = parameter.find('=');
+        std::string name = parameter.substr(0, equals);
+        std::string value = equals == std::string::npos ? "" : parameter.substr(equals + 1);
+
+        if (name == "iterations") {
+            std::istringstream number(value);
+            if (!(number >> tile.iterations) || !number.eof() || tile.iterations <= 0) return 400;
+
+            tile.iterations = std::min(tile.iterations, options.maxIterations);
+        } else if (name == "fractal") {
+            if (value == "mandelbrot") tile.fractal = FractalType::Mandelbrot;
+            else if (value == "julia") tile.fractal = FractalType::Julia;
+            else if (value == "multibrot") tile.fractal = FractalType::Multibrot;
+            else if (value == "burning-ship") tile.fractal = FractalType::BurningShip;
+            else return 400;
+        } else if (name == "re" || name == "im") {
+            std::istringstream number(value);
+            double part;
+            if (!(number >> part) || !number.eof() || !std::isfinite(part)) return 400;
+
+            if (name == "re") tile.juliaSeed.real(part);
+            else tile.juliaSeed.imag(part);
+        } else if (name == "smooth") {
+            tile.smooth = value == "1" || value == "true";
+        } else if (name == "palette") {
+            if (!ParsePalette(value, tile.palette)) return 400;
+        } else if (name == "cycle") {
+            std::istringstream number(value);
+            if (!(number >> tile.paletteCycle) || !number.eof() || !std::isfinite(tile.paletteCycle) || tile.paletteCycle < 0) return 400;
+        } else if (name == "power") {
+            std::istringstream number(value);
+            if (!(number >> tile.power) || !number.eof() || tile.power < 2 || tile.power > 16) return 400;
+        }
+    }
+
+    // Only the Mandelbrot set has a deep zoom engine
+    if (tile.fractal != FractalType::Mandelbrot && std::ldexp(1.0, tile.zoom + webTileLevelOffset) > doubleFloatPrecisionResolution) return 404;
+
+    return 200;
+}
+
+static bool SendResponse(sf::TcpSocket &socket, int status, const char *contentType, const void *body, size_t size, bool keepAlive) {
+    const char *reason = "OK";
+    if (status == 400) reason = "Bad Request";
+    else if (status == 404) reason = "Not Found";
+    else if (status == 405) reason = "Method Not Allowed";
+    else if (status == 503) reason = "Service Unavailable";
+
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << " " << reason << "\r\n";
+    head << "Content-Type: " << contentType << "\r\n";
+    head << "Content-Length: " << size << "\r\n";
+    head << "Access-Control-Allow-Origin: *\r\n";
+
+    // Tiles never change for a URL, errors are worth asking again
+    if (status == 200) head << "Cache-Control: public, max-age=86400\r\n";
+    else head << "Cache-Control: no-store\r\n";
+
+    if (status == 503) head << "Retry-After: 1\r\n";
+
+    head << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+
+    std::string text = head.str();
+
+    if (socket.send(text.data(), text.size()) != sf::Socket::Status::Done) return false;
+    return size == 0 || socket.send(body, size) == sf::Socket::Status::Done;
+}
+
+static bool SendText(sf::TcpSocket &socket, int status, const char *contentType, const std::string &text, bool keepAlive) {
+    return SendResponse(socket, status, contentType, text.data(), text.size(), keepAlive);
+}
+
+bool TileServer::WaitForRequest(sf::SocketSelector &selector) {
+    for (float waited = 0; waited < keepAliveSeconds; waited += 1.0f) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return false;
+        }
+
+        if (selector.wait(sf::seconds(1.0f))) return true;
+    }
+
+    return false;
+}
+
+void TileServer::Serve(std::unique_ptr<sf::TcpSocket> socket) {
+    sf::SocketSelector selector;
+    selector.add(*socket);
+
+    std::string buffer;
+    char chunk[4096];
+
+    while (true) {
+        size_t headEnd;
+
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (buffer.size() > maxRequestHeadBytes || !WaitForRequest(selector)) return;
+
+            size_t received = 0;
+            if (socket->receive(chunk, sizeof(chunk), received) != sf::Socket::Status::Done) return;
+
+            buffer.append(chunk, received);
+        }
+
+        std::string head = buffer.substr(0, headEnd);
+        buffer.erase(0, headEnd + 4);
+
+        std::string method, target, version;
+        std::istringstream requestLine(head.substr(0, head.find("\r\n")));
+        requestLine >> method >> target >> version;
+
+        std::string lowered = head;
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        bool keepAlive = version == "HTTP/1.1" && lowered.find("connection: close") == std::string::npos;
+
+        // Bodies aren't read, so anything with one ends the connection
+        if (method != "GET") {
+            SendText(*socket, 405, "text/plain", "Only GET is supported\n", false);
+            return;
+        }
+
+        bool sent;
+        WebTile tile;
+        int status;
+
+        if (target == "/" || target.rfind("/?", 0) == 0) {
+            sent = SendText(*socket, 200, "text/html; charset=utf-8", viewerPage, keepAlive);
+        } else if (target == "/stats") {
+            sent = SendText(*socket, 200, "application/json", GetStats(), keepAlive);
+        } else if ((status = ParseTileTarget(target, options, tile)) != 200) {
+            sent = SendText(*socket, status, "text/plain", status == 400 ? "Bad tile parameters\n" : "No such tile\n", keepAlive);
+        } else {
+            EncodedTile encoded = GetTile(tile);
+
+            if (encoded) sent = SendResponse(*socket, 200, "image/png", encoded->data(), encoded->size(), keepAlive);
+            else sent = SendText(*socket, 503, "text/plain", "Render queue is full\n", keepAlive);
+        }
+
+        if (!sent || !keepAlive) return;
+    }
+}
+
+bool TileServer::Run() {
+    sf::TcpListener listener;
+
+    if (listener.listen(options.port) != sf::Socket::Status::Done) {
+        std::cout << "An error occured when trying to listen on port " << options.port << "!\n";
+        return false;
+    }
+
+    std::cout << "Serving tiles on http://localhost:" << options.port << "/\n";
+
+    while (true) {
+        JoinFinishedConnections();
+
+        std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+
+        if (listener.accept(*socket) != sf::Socket::Status::Done) {
+            std::cout << "An error occured when trying to accept a connection!\n";
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (connections >= maxConnections) continue;
+            connections++;
+        }
+
+        // Kept joinable, so the destructor can wait for connections still using the server
+        std::thread thread([this](std::unique_ptr<sf::TcpSocket> socket) {
+            Serve(std::move(socket));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            connections--;
+            finishedConnections.push_back(std::this_thread::get_id());
+        }, std::move(socket));
+
+        std::thread::id id = thread.get_id();
+        connectionThreads[id] = std::move(thread);
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Network/SocketSelector.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+#include "core/render.hpp"
+#include "core/tile-cache.hpp"
+#include "core/tiled-backend.hpp"
+
+// Map tiles are webTileSize pixels a side. Zoom z splits the square from -2 - 2i to 2 + 2i into 2^z tiles a side,
+// which is a resolution of 2^(z + 6), so every map tile is made of whole tiles of the cache pyramid
+const int webTileSize = 256;
+const int webTileLevelOffset = 6;
+
+// Past this tile centers stop being exact in a double
+const int maxWebZoom = 52;
+
+struct TileServerOptions {
+    unsigned short port = 8080;
+
+    // Iteration limit of tiles that don't ask for one, and the most a tile may ask for
+    int defaultIterations = 500;
+    int maxIterations = 100000;
+
+    // Tiles waiting for a render. When it's full the lowest priority one is answered with a 503
+    size_t queueCapacity = 256;
+
+    // Encoded tiles kept for repeated requests
+    size_t responseCapacity = 4096;
+
+    // Spill directory of the tile cache, empty keeps it in memory
+    std::string spillDirectory;
+};
+
+// Everything in a tile URL that changes the picture
+struct WebTile {
+    int zoom = 0;
+    int64_t x = 0;
+    int64_t y = 0;
+    int iterations = 0;
+
+    FractalType fractal = FractalType::Mandelbrot;
+    std::complex<double> juliaSeed;
+    int power = 3;
+
+    bool smooth = false;
+    PaletteType palette = PaletteType::Greyscale;
+    double paletteCycle = 0;
+};
+
+typedef std::shared_ptr<const std::vector<uint8_t>> EncodedTile;
+
+// Serves /z/x/y.png over HTTP/1.1 with keep-alive, one thread per connection. Renders happen one at a time on a
+// render thread, newest request first with the zoom level asked for last ahead of the rest, since those are the
+// tiles on screen. Requests for a tile that is already queued wait for the same render
+class TileServer {
+public:
+    // backend renders zoom levels up to doubleFloatPrecisionResolution, deepBackend the ones past it. Backends that
+    // keep escape counts render through the tile cache
+    TileServer(RenderBackend &backend, RenderBackend &deepBackend, const TileServerOptions &options);
+    ~TileServer();
+
+    TileServer(const TileServer &) = delete;
+    TileServer &operator=(const TileServer &) = delete;
+
+    // Accepts connections until the listener fails. Returns false when the port can't be opened. Connections
+    // still open are closed when the server is destroyed
+    bool Run();
+
+    // Encoded tile from the response cache, from a render of the same tile already on its way, or from a new
+    // one. Blocks until it's there. nullptr when the request was pushed out of the queue or failed to render
+    EncodedTile GetTile(const WebTile &tile);
+
+private:
+    struct Pending {
+        WebTile tile;
+        std::string key;
+        uint64_t sequence = 0;
+        std::promise<EncodedTile> promise;
+        std::shared_future<EncodedTile> result;
+    };
+
+    bool IsLowerPriority(const std::shared_ptr<Pending> &a, const std::shared_ptr<Pending> &b) const;
+
+    void RenderLoop();
+    bool RenderTile(const WebTile &tile, EncodedTile &encoded);
+
+    void Serve(std::unique_ptr<sf::TcpSocket> socket);
+
+    // Waits for selector to have data for up to the keep-alive time. False when it doesn't or the server is stopping
+    bool WaitForRequest(sf::SocketSelector &selector);
+
+    // Joins the connection threads that have returned, only called from the thread of Run and the destructor
+    void JoinFinishedConnections();
+    std::string GetStats();
+
+    TileServerOptions options;
+
+    // Only touched by the render thread
+    TileCache cache;
+    TiledBackend shallowTiler;
+    TiledBackend deepTiler;
+    sf::Image image;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Queued tiles, and every tile queued or rendering by URL key
+    std::vector<std::shared_ptr<Pending>> queue;
+    std::unordered_map<std::string, std::shared_ptr<Pending>> inFlight;
+    uint64_t sequence = 0;
+    int latestZoom = 0;
+
+    // Least recently used encoded tiles, front is the most recent
+    std::list<std::pair<std::string, EncodedTile>> responses;
+    std::unordered_map<std::string, std::list<std::pair<std::string, EncodedTile>>::iterator> responseIndex;
+
+    // Connection threads by id, and the ids of those that have returned and can be joined
+    std::unordered_map<std::thread::id, std::thread> connectionThreads;
+    std::vector<std::thread::id> finishedConnections;
+
+    int connections = 0;
+    long long requests = 0;
+    long long responseHits = 0;
+    long long coalesced = 0;
+    long long rendered = 0;
+    long long dropped = 0;
+
+    std::thread renderThread;
+};
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+#include "core/tiled-backend.hpp"
+#include "core/bigfloat.hpp"
+#include "core/cpu-kernel.hpp"
+
+// Ancestors this many levels up can stand in for a missing tile, further up they are too blurry to help
+const int placeholderLevels = 4;
+
+// Widest row of neighbouring tiles handed to the backend in one request
+const int maxRunTiles = 16;
+
+static int64_t FloorDivide(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return quotient * divisor > value ? quotient - 1 : quotient;
+}
+
+bool TiledBackend::GetTileLevel(const RenderRequest &request, int &level) {
+    int exponent;
+    double mantissa = std::frexp(request.resolution, &exponent);
+
+    // frexp gives a mantissa of exactly 0.5 for powers of two
+    level = exponent - 1;
+    return mantissa == 0.5 && level >= 0 && level <= maxTileLevel;
+}
+
+// Pixel of the level closest to the first pixel of size pixels along one axis. A decimal pivot wins over the double
+// one, it is split into its closest double and the rest, and scaling by a power of two is exact, so only the fraction
+// of a pixel is ever rounded
+static int64_t GetOriginAxis(double pivot, const std::string &deepPivot, int level, int size) {
+    double rest = 0;
+
+    if (!deepPivot.empty()) {
+        int limbs = BigFloat::LimbsForResolution(std::ldexp(1.0, level) * size);
+        BigFloat exact = BigFloat::FromString(deepPivot, limbs);
+
+        pivot = exact.ToDouble();
+        rest = (exact - BigFloat::FromDouble(pivot, limbs)).ToDouble();
+    }
+
+    double scaled = std::ldexp(pivot, level);
+    double whole = std::floor(scaled);
+
+    return (int64_t) whole + std::llround(scaled - whole + std::ldexp(rest, level) - (float) size / 2.0f);
+}
+
+// Pixel of the level closest to the first pixel of the frame
+static void GetOrigin(const RenderRequest &request, int level, int64_t &x, int64_t &y) {
+    x = GetOriginAxis(request.pivot.real(), request.deepPivotReal, level, request.width);
+    y = GetOriginAxis(request.pivot.imag(), request.deepPivotImag, level, request.height);
+}
+
+void TiledBackend::Fill(const RenderRequest &request, int level, int64_t originX, int64_t originY, std::vector<TileKey> *missing) {
+    int width = request.width;
+    int height = request.height;
+
+    iterationBuffer.Reserve(width, height, request.smooth);
+    uint32_t *counts = iterationBuffer.GetCounts();
+    float *fractions = iterationBuffer.GetFractions();
+    size_t tileArea = (size_t) tileSize * tileSize;
+
+    int64_t firstX = FloorDivide(originX, tileSize);
+    int64_t firstY = FloorDivide(originY, tileSize);
+    int64_t lastX = FloorDivide(originX + width - 1, tileSize);
+    int64_t lastY = FloorDivide(originY + height - 1, tileSize);
+
+    for (int64_t ty = firstY; ty <= lastY; ty++) {
+        for (int64_t tx = firstX; tx <= lastX; tx++) {
+            TileKey key = {level, tx, ty};
+
+            // Part of the tile inside the frame, in pixels of the level
+            int64_t left = std::max(originX, tx * tileSize);
+            int64_t right = std::min(originX + width, (tx + 1) * tileSize);
+            int64_t top = std::max(originY, ty * tileSize);
+            int64_t bottom = std::min(originY + height, (ty + 1) * tileSize);
+
+            TileData tile = cache.Find(key);
+
+            if (tile) {
+                for (int64_t y = top; y < bottom; y++) {
+                    size_t source = (y - ty * tileSize) * tileSize + (left - tx * tileSize);
+                    size_t target = (y - originY) * width + (left - originX);
+
+                    std::copy_n(tile->data() + source, right - left, counts + target);
+                    if (fractions) std::memcpy(fractions + target, tile->data() + tileArea + source, (right - left) * sizeof(float));
+                }
+
+                continue;
+            }
+
+            if (missing) missing->push_back(key);
+
+            // A tile k levels up covers this one with 2^k times fewer pixels
+            TileData ancestor;
+            int up = 1;
+
+            for (; up <= placeholderLevels && level - up >= 0 && !ancestor; up++) {
+                ancestor = cache.Find({level - up, FloorDivide(tx, (int64_t) 1 << up), FloorDivide(ty, (int64_t) 1 << up)});
+            }
+
+            up--;
+
+            for (int64_t y = top; y < bottom; y++) {
+                uint32_t *out = counts + (y - originY) * width - originX;
+                float *fractionOut = fractions ? fractions + (y - originY) * width - originX : nullptr;
+
+                if (!ancestor) {
+                    std::fill(out + left, out + right, request.iterations);
+                    if (fractionOut) std::fill(fractionOut + left, fractionOut + right, 0.0f);
+                    continue;
+                }
+
+                int64_t scale = (int64_t) 1 << up;
+                int64_t ancestorRow = FloorDivide(y, scale) - FloorDivide(ty, scale) * tileSize;
+                int64_t ancestorLeft = FloorDivide(tx, scale) * tileSize;
+
+                for (int64_t x = left; x < right; x++) {
+                    size_t source = ancestorRow * tileSize + FloorDivide(x, scale) - ancestorLeft;
+
+                    out[x] = (*ancestor)[source];
+                    if (fractionOut) std::memcpy(fractionOut + x, ancestor->data() + tileArea + source, sizeof(float));
+                }
+            }
+        }
+    }
+}
+
+void TiledBackend::Shade(const RenderRequest &request, sf::Image &image) {
+    size_t size = (size_t) request.width * request.height;
+
+    if (size > pixelsSize) {
+        pixels.reset(new uint8_t[size * 4]);
+        pixelsSize = size;
+    }
+
+    const uint32_t *counts = iterationBuffer.GetCounts();
+    const float *levels = nullptr;
+
+    if (request.equalize && request.levels) {
+        levels = request.levels;
+    } else if (request.equalize) {
+        equalizer.Build(counts, size, request.iterations, nullptr);
+        levels = equalizer.GetLevels();
+    }
+
+    ShadeTile(counts, iterationBuffer.GetFractions(), request, levels, pixels.get(), request.width, 0, 0, request.width, request.height);
+
+    image = sf::Image(sf::Vector2u(request.width, request.height), pixels.get());
+}
+
+bool TiledBackend::Assemble(const RenderRequest &request, sf::Image &image, std::vector<TileKey> &missing) {
+    int level;
+    if (!GetTileLevel(request, level)) return false;
+
+    cache.SetParameters(request);
+
+    int64_t originX, originY;
+    GetOrigin(request, level, originX, originY);
+
+    missing.clear();
+    Fill(request, level, originX, originY, &missing);
+
+    // Closest to the middle of the frame first, that's where the eye is
+    double centerX = originX + request.width / 2.0;
+    double centerY = originY + request.height / 2.0;
+
+    auto distance = [&](const TileKey &key) {
+        return std::hypot((key.x + 0.5) * tileSize - centerX, (key.y + 0.5) * tileSize - centerY);
+    };
+
+    std::sort(missing.begin(), missing.end(), [&](const TileKey &a, const TileKey &b) {
+        return distance(a) < distance(b);
+    });
+
+    tiled = true;
+    Shade(request, image);
+
+    return true;
+}
+
+bool TiledBackend::RenderMissing(const RenderRequest &request, std::vector<TileKey> &missing, double budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unordered_set<TileKey, TileKeyHash> pending(missing.begin(), missing.end());
+
+    for (const TileKey &first : missing) {
+        if (pending.count(first) == 0) continue;
+
+        // Grow a run over the missing neighbours in the same row
+        int64_t left = first.x;
+        int64_t right = first.x;
+
+        while (right - left + 1 < maxRunTiles && pending.count({first.level, left - 1, first.y})) left--;
+        while (right - left + 1 < maxRunTiles && pending.count({first.level, right + 1, first.y})) right++;
+
+        int runTiles = right - left + 1;
+
+        RenderRequest run = request;
+        run.width = runTiles * tileSize;
+        run.height = tileSize;
+        run.resolution = std::ldexp(1.0, first.level);
+
+        // Exact in a double up to maxTileLevel, so the backends need no decimal pivot
+        run.pivot = std::complex<double>(std::ldexp(left * tileSize + run.width / 2.0, -first.level), std::ldexp(first.y * tileSize + tileSize / 2.0, -first.level));
+        run.deepPivotReal.clear();
+        run.deepPivotImag.clear();
+
+        // Only the counts are kept, the backend's colouring of the run is thrown away
+        run.equalize = false;
+        run.antialias = 0;
+
+        if (!backend.Render(run, runImage)) return false;
+
+        const uint32_t *counts = backend.GetIterations()->GetCounts();
+        const float *fractions = backend.GetIterations()->GetFractions();
+        size_t tileArea = (size_t) tileSize * tileSize;
+
+        for (int k = 0; k < runTiles; k++) {
+            std::shared_ptr<std::vector<uint32_t>> tile = std::make_shared<std::vector<uint32_t>>(cache.GetTileWords());
+
+            for (int y = 0; y < tileSize; y++) {
+                size_t source = (size_t) y * run.width + k * tileSize;
+
+                std::copy_n(counts + source, tileSize, tile->data() + y * tileSize);
+                if (fractions) std::memcpy(tile->data() + tileArea + y * tileSize, fractions + source, tileSize * sizeof(float));
+            }
+
+            TileKey key = {first.level, left + k, first.y};
+            cache.Insert(key, tile);
+            pending.erase(key);
+            renderedTiles++;
+        }
+
+        if (budgetMs >= 0 && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > budgetMs) break;
+    }
+
+    missing.erase(std::remove_if(missing.begin(), missing.end(), [&](const TileKey &key) {
+        return pending.count(key) == 0;
+    }), missing.end());
+
+    return true;
+}
+
+bool TiledBackend::Render(const RenderRequest &request, sf::Image &image) {
+    int level;
+    tiled = GetTileLevel(request, level) && backend.GetIterations() != nullptr;
+
+    // Frames with more tiles than the cache holds would push their own first tiles out before they are copied
+    int64_t tilesAcross = request.width / tileSize + 2;
+    int64_t tilesDown = request.height / tileSize + 2;
+    tiled = tiled && (size_t) (tilesAcross * tilesDown) <= cache.GetCapacity() / 2;
+
+    if (!tiled) return backend.Render(request, image);
+
+    cache.SetParameters(request);
+
+    int64_t originX, originY;
+    GetOrigin(request, level, originX, originY);
+
+    std::vector<TileKey> missing;
+    Fill(request, level, originX, originY, &missing);
+
+    if (!missing.empty()) {
+        if (!RenderMissing(request, missing, -1)) return false;
+
+        Fill(request, level, originX, originY, nullptr);
+    }
+
+    Shade(request, image);
+
+    return true;
+}
+
+bool TiledBackend::Recolor(const RenderRequest &request, sf::Image &image) {
+    if (!tiled) return backend.Recolor(request, image);
+    if (!CanRecolor(iterationBuffer, request)) return false;
+
+    Shade(request, image);
+
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/render.hpp"
+#include "core/iteration-buffer.hpp"
+#include "core/histogram.hpp"
+#include "core/tile-cache.hpp"
+
+// Assembles frames at power of two resolutions from a pyramid of cached tiles, rendering only the missing tiles
+// through the wrapped backend, which has to expose its escape counts. Other frames go straight to that backend.
+// Frames are snapped to the pixel grid of their level, which moves them by at most half a pixel. Tiles only hold
+// counts, so assembled frames are not anti-aliased
+class TiledBackend : public RenderBackend {
+public:
+    TiledBackend(RenderBackend &backend, TileCache &cache) : backend(backend), cache(cache) {}
+
+    const char *GetName() const override { return backend.GetName(); }
+
+    bool Render(const RenderRequest &request, sf::Image &image) override;
+
+    // Shades the last assembled frame again, or hands the request to the backend when the frame wasn't tiled
+    bool Recolor(const RenderRequest &request, sf::Image &image) override;
+
+    const IterationBuffer *GetIterations() const override { return tiled ? &iterationBuffer : backend.GetIterations(); }
+
+    Continuation *GetContinuation() override { return backend.GetContinuation(); }
+
+    int GetThreadCount() const override { return backend.GetThreadCount(); }
+
+    // Level of the pyramid request sits on. False when its resolution isn't a power of two up to maxTileLevel
+    static bool GetTileLevel(const RenderRequest &request, int &level);
+
+    // Fills image from the cache alone, drawing missing tiles from a cached ancestor scaled up. missing gets the
+    // tiles still to render, nearest to the center first. Returns false when request isn't on the pyramid
+    bool Assemble(const RenderRequest &request, sf::Image &image, std::vector<TileKey> &missing);
+
+    // Renders tiles of missing into the cache, a run of neighbours in a row per backend call, until budgetMs has
+    // passed or all are done. A negative budget never stops early. Rendered tiles are removed from missing
+    bool RenderMissing(const RenderRequest &request, std::vector<TileKey> &missing, double budgetMs);
+
+    long long GetRenderedTiles() const { return renderedTiles; }
+
+private:
+    // Copies the tiles covering request into the iteration buffer. origin is the pixel of the level that lands on
+    // the first pixel of the frame
+    void Fill(const RenderRequest &request, int level, int64_t originX, int64_t originY, std::vector<TileKey> *missing);
+    void Shade(const RenderRequest &request, sf::Image &image);
+
+    RenderBackend &backend;
+    TileCache &cache;
+
+    // Whether the last frame came from tiles, and so whose escape counts are the current ones
+    bool tiled = false;
+
+    IterationBuffer iterationBuffer;
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t pixelsSize = 0;
+
+    // Assembled frames are equalized on the calling thread, the wrapped backend's workers are not reachable here
+    HistogramEqualizer equalizer;
+
+    sf::Image runImage;
+    long long renderedTiles = 0;
+};
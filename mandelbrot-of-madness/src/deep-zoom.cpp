@@ -0,0 +1,38 @@
+#include <iostream>
+
+#include "core/prompt.hpp"
+#include "core/command-line.hpp"
+#include "core/perturbation-backend.hpp"
+#include "core/bigfloat.hpp"
+
+int main(int argc, char **argv) {
+    CommandLine commandLine;
+    if (!ParseCommandLine(argc, argv, commandLine)) return -1;
+
+    if (commandLine.jobs.empty()) {
+        RenderJob job;
+
+        std::cout << "Enter pivot real part: ";
+        std::cin >> job.request.deepPivotReal;
+
+        std::cout << "Enter pivot imaginary part: ";
+        std::cin >> job.request.deepPivotImag;
+
+        // Anything that places the frame without the decimal strings, such as the tile cache, reads the double pivot
+        int limbs = BigFloat::LimbsForResolution(1);
+        job.request.pivot = std::complex<double>(BigFloat::FromString(job.request.deepPivotReal, limbs).ToDouble(),
+                                                 BigFloat::FromString(job.request.deepPivotImag, limbs).ToDouble());
+
+        PromptRenderJob(job.request, job.filepath);
+
+        commandLine.jobs.push_back(job);
+    }
+
+    PerturbationBackend backend(commandLine.threading);
+
+    int result = RunRenderJobs(backend, commandLine);
+
+    std::cout << "\nSkipped " << backend.GetSkippedIterations() << " iterations with series approximation, reference orbit length " << backend.GetReferenceLength() << "\n";
+
+    return result;
+}
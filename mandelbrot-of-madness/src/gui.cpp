@@ -1,41 +1,92 @@
 #include <iostream>
 #include <string>
 #include <optional>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
 
 #include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Shader.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/RectangleShape.hpp>
-
-const char mandelbrotShaderSource[] = R"(
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "core/bigfloat.hpp"
+#include "core/palette.hpp"
+#include "core/double-float.hpp"
+#include "core/perturbation-backend.hpp"
+#include "core/region-request.hpp"
+#include "core/tiled-backend.hpp"
+
+// Progressive refinement. A view change restarts at the coarsest pixel scale that fits the frame budget, then
+// every frame the view stays still renders another band of the next finer pass, until it reaches full resolution
+const double frameBudgetMs = 1000.0 / 30.0;
+const int coarsestScale = 16;
+
+// Shared head of every shader. Colours come from the palette texture, paletteSize entries and the interior one
+const char shadingShaderHeader[] = R"(
 #version 110
 
+uniform sampler2D u_palette;
+uniform float u_paletteEntries;
+uniform float u_paletteScale;
+uniform bool u_smooth;
+
+// Squared escape radius, large for smooth frames so the fractional part is accurate
+uniform float u_bailout;
+
+vec4 shade(int iter, float norm) {
+    if (norm <= u_bailout) return texture2D(u_palette, vec2((u_paletteEntries + 0.5) / (u_paletteEntries + 1.0), 0.5));
+
+    float mu = float(iter);
+    if (u_smooth) mu += clamp(1.0 - log2(log(norm) / log(u_bailout)), 0.0, 1.0);
+
+    float index = mod(floor(mu * u_paletteScale), u_paletteEntries);
+    return texture2D(u_palette, vec2((index + 0.5) / (u_paletteEntries + 1.0), 0.5));
+}
+)";
+
+const char mandelbrotShaderSource[] = R"(
 uniform vec2 u_dimensions;
 uniform float u_resolution;
 uniform int u_iterations;
 uniform vec2 u_pivot;
 uniform vec2 u_origin;
 
+bool inMainCardioidOrBulb(vec2 c) {
+    float yy = c.y * c.y;
+
+    float xr = c.x - 0.25;
+    float q = xr * xr + yy;
+    if (q * (q + xr) <= 0.25 * yy) return true;
+
+    float br = c.x + 1.0;
+    return br * br + yy <= 0.0625;
+}
+
 void main() {
     vec2 c = u_pivot + (gl_FragCoord.xy - u_dimensions / vec2(2.0, 2.0)) / vec2(u_resolution, u_resolution);
     vec2 z = c;
 
-    int iter = 0;
-    for (int i = 0; i < u_iterations; i++) {
-        if (dot(z, z) > 2.0) break;
-        z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
-        iter = i;
+    // Points in the cardioid or the period-2 bulb never escape, so they take the full count without iterating
+    int iter = u_iterations - 1;
+
+    if (!inMainCardioidOrBulb(c)) {
+        iter = 0;
+        for (int i = 0; i < u_iterations; i++) {
+            if (dot(z, z) > u_bailout) break;
+            z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
+            iter = i;
+        }
     }
-    
-    vec3 color = mix(vec3(1.0, 1.0, 1.0), vec3(0.0, 0.0, 0.0), float(iter) / float(u_iterations));
 
-    gl_FragColor = vec4(color, 1.0);
+    gl_FragColor = shade(iter, dot(z, z));
 }
 )";
 
 const char juliaShaderSource[] = R"(
-#version 110
-
 uniform vec2 u_dimensions;
 uniform float u_resolution;
 uniform int u_iterations;
@@ -48,37 +99,291 @@ void main() {
 
     int iter = 0;
     for (int i = 0; i < u_iterations; i++) {
-        if (dot(z, z) > 4.0) break;
+        if (dot(z, z) > u_bailout) break;
         z = vec2(z.x * z.x - z.y * z.y, 2.0 * z.x * z.y) + c;
         iter = i;
     }
-    
-    vec3 color = mix(vec3(1.0, 1.0, 1.0), vec3(0.0, 0.0, 0.0), float(iter) / float(u_iterations));
 
-    gl_FragColor = vec4(color, 1.0);
+    gl_FragColor = shade(iter, dot(z, z));
+}
+)";
+
+// Shared head of the double-float shaders. Values are the unevaluated sum hi + lo of two floats
+const char doubleFloatShaderHeader[] = R"(
+uniform vec2 u_dimensions;
+uniform vec2 u_pixelSize;
+uniform int u_iterations;
+uniform vec4 u_pivot;
+uniform vec2 u_origin;
+
+// Always 4097.0, passed in so the compiler can't fold the error terms of dfSplit away
+uniform float u_split;
+
+vec2 dfQuickTwoSum(float a, float b) {
+    float s = a + b;
+    return vec2(s, b - (s - a));
+}
+
+vec2 dfTwoSum(float a, float b) {
+    float s = a + b;
+    float v = s - a;
+    return vec2(s, (a - (s - v)) + (b - v));
+}
+
+vec2 dfSplit(float a) {
+    float t = u_split * a;
+    float hi = t - (t - a);
+    return vec2(hi, a - hi);
+}
+
+vec2 dfTwoProduct(float a, float b) {
+    float p = a * b;
+    vec2 sa = dfSplit(a);
+    vec2 sb = dfSplit(b);
+    return vec2(p, ((sa.x * sb.x - p) + sa.x * sb.y + sa.y * sb.x) + sa.y * sb.y);
+}
+
+vec2 dfAdd(vec2 a, vec2 b) {
+    vec2 s = dfTwoSum(a.x, b.x);
+    return dfQuickTwoSum(s.x, s.y + a.y + b.y);
+}
+
+vec2 dfMul(vec2 a, vec2 b) {
+    vec2 p = dfTwoProduct(a.x, b.x);
+    return dfQuickTwoSum(p.x, p.y + a.x * b.y + a.y * b.x);
+}
+
+// Coordinates of this fragment as (re.hi, re.lo, im.hi, im.lo)
+vec4 fragmentPoint() {
+    vec2 offset = gl_FragCoord.xy - u_dimensions / vec2(2.0, 2.0);
+    return vec4(dfAdd(u_pivot.xy, dfMul(vec2(offset.x, 0.0), u_pixelSize)), dfAdd(u_pivot.zw, dfMul(vec2(offset.y, 0.0), u_pixelSize)));
+}
+)";
+
+const char mandelbrotDoubleFloatShaderSource[] = R"(
+// In double-float, rounding c to float would move the boundary by more than a pixel at these zooms
+bool inMainCardioidOrBulb(vec2 cr, vec2 ci) {
+    vec2 yy = dfMul(ci, ci);
+
+    vec2 xr = dfAdd(cr, vec2(-0.25, 0.0));
+    vec2 q = dfAdd(dfMul(xr, xr), yy);
+    if (dfAdd(dfMul(q, dfAdd(q, xr)), -0.25 * yy).x <= 0.0) return true;
+
+    vec2 br = dfAdd(cr, vec2(1.0, 0.0));
+    return dfAdd(dfAdd(dfMul(br, br), yy), vec2(-0.0625, 0.0)).x <= 0.0;
+}
+
+void main() {
+    vec4 c = fragmentPoint();
+    vec2 zr = c.xy;
+    vec2 zi = c.zw;
+
+    int iter = u_iterations - 1;
+
+    if (!inMainCardioidOrBulb(c.xy, c.zw)) {
+        iter = 0;
+        for (int i = 0; i < u_iterations; i++) {
+            vec2 xx = dfMul(zr, zr);
+            vec2 yy = dfMul(zi, zi);
+            if (xx.x + yy.x > u_bailout) break;
+
+            vec2 xy = dfMul(zr, zi);
+            zr = dfAdd(dfAdd(xx, -yy), c.xy);
+            zi = dfAdd(dfAdd(xy, xy), c.zw);
+            iter = i;
+        }
+    }
+
+    gl_FragColor = shade(iter, zr.x * zr.x + zi.x * zi.x);
+}
+)";
+
+const char juliaDoubleFloatShaderSource[] = R"(
+void main() {
+    vec4 z = fragmentPoint();
+    vec2 zr = z.xy;
+    vec2 zi = z.zw;
+    vec2 cr = vec2(u_origin.x, 0.0);
+    vec2 ci = vec2(u_origin.y, 0.0);
+
+    int iter = 0;
+    for (int i = 0; i < u_iterations; i++) {
+        vec2 xx = dfMul(zr, zr);
+        vec2 yy = dfMul(zi, zi);
+        if (xx.x + yy.x > u_bailout) break;
+
+        vec2 xy = dfMul(zr, zi);
+        zr = dfAdd(dfAdd(xx, -yy), cr);
+        zi = dfAdd(dfAdd(xy, xy), ci);
+        iter = i;
+    }
+
+    gl_FragColor = shade(iter, zr.x * zr.x + zi.x * zi.x);
 }
 )";
 
 int main(int argc, char **argv) {
     int width = 800;
     int height = 600;
-    float resolution = 256;
+    double resolution = 256;
     int iterations = 200;
-    sf::Vector2f pivot;
+
+    // Panning adds pixel offsets to these, so they need more precision than the zoom they are viewed at
+    BigFloat pivotReal = BigFloat(BigFloat::LimbsForResolution(resolution));
+    BigFloat pivotImag = BigFloat(BigFloat::LimbsForResolution(resolution));
     
     bool julia = false;
     bool locked = false;
+    bool tiled = false;
     sf::Vector2f origin;
 
+    bool smooth = false;
+    PaletteType palette = PaletteType::Greyscale;
+    int paletteCycle = 0;
+
     bool rerender = true;
+
+    // Set by anything but a pan, which can shift the last complete frame over by the pixels it moved
+    bool recompute = true;
+    int panX = 0;
+    int panY = 0;
     bool dragged = false;
     sf::Vector2i lastMousePos;
 
-    sf::Shader mandelbrotShader = sf::Shader(std::string_view(mandelbrotShaderSource), sf::Shader::Type::Fragment);
-    sf::Shader juliaShader = sf::Shader(std::string_view(juliaShaderSource), sf::Shader::Type::Fragment);
+    sf::Shader mandelbrotShader = sf::Shader(std::string(shadingShaderHeader) + mandelbrotShaderSource, sf::Shader::Type::Fragment);
+    sf::Shader juliaShader = sf::Shader(std::string(shadingShaderHeader) + juliaShaderSource, sf::Shader::Type::Fragment);
     sf::Shader *p_shader = &mandelbrotShader;
 
+    sf::Shader mandelbrotDoubleFloatShader = sf::Shader(std::string(shadingShaderHeader) + doubleFloatShaderHeader + mandelbrotDoubleFloatShaderSource, sf::Shader::Type::Fragment);
+    sf::Shader juliaDoubleFloatShader = sf::Shader(std::string(shadingShaderHeader) + doubleFloatShaderHeader + juliaDoubleFloatShaderSource, sf::Shader::Type::Fragment);
+
+    // One texel per palette entry, the same table the CPU backends shade with
+    sf::Texture paletteTexture = sf::Texture(sf::Vector2u(paletteSize + 1, 1));
+    paletteTexture.update(reinterpret_cast<const std::uint8_t *>(GetPaletteTable(palette)));
+
+    // Keeps the per-pixel state of the full resolution pass, so changing the iteration limit only continues it
+    MultiThreadedOptions deepOptions;
+    deepOptions.keepContinuation = true;
+
+    PerturbationBackend deepBackend(deepOptions);
+    Continuation &deepContinuation = *deepBackend.GetContinuation();
+    sf::Image deepImage;
+    sf::Texture deepTexture;
+
+    // Tiled mode assembles the view from a cache of tiles on the CPU, so zooming back out or revisiting a spot
+    // is free and a new level starts from its parent's tiles scaled up
+    MultiThreadedBackend tileBackend;
+    PerturbationBackend deepTileBackend;
+    TileCache tileCache;
+    TiledBackend shallowTiler = TiledBackend(tileBackend, tileCache);
+    TiledBackend deepTiler = TiledBackend(deepTileBackend, tileCache);
+    std::vector<TileKey> tileMissing;
+    sf::Image tileImage;
+    sf::Texture tileTexture;
+
     sf::RectangleShape surface = sf::RectangleShape(sf::Vector2f(width, height));
+
+    // Two canvases, one with the last complete pass and one that the next finer pass is drawn into
+    sf::RenderTexture canvases[2];
+    int shown = 0;
+    int shownScale = 0;
+
+    // Pixel scale and progress of the pass in progress, a scale of 0 means the view is fully refined
+    int passScale = 0;
+    int passRow = 0;
+
+    // Measured milliseconds per pass pixel, the shaders and the deep zoom engine are far apart
+    double shaderCost = 0;
+    double deepCost = 0;
+
+    // Deep zoom request for the whole view at 1 / scale of the window resolution
+    auto deepViewRequest = [&](int scale, int passWidth, int passHeight) {
+        RenderRequest request;
+        request.width = passWidth;
+        request.height = passHeight;
+        request.resolution = resolution / scale;
+        request.iterations = iterations;
+        request.pivot = std::complex<double>(pivotReal.ToDouble(), pivotImag.ToDouble());
+        request.deepPivotReal = pivotReal.ToString();
+        request.deepPivotImag = pivotImag.ToString();
+        request.smooth = smooth;
+        request.palette = palette;
+        request.paletteCycle = paletteCycle;
+
+        return request;
+    };
+
+    auto setShading = [&](sf::Shader &shader) {
+        RenderRequest request = deepViewRequest(1, width, height);
+
+        // Without smooth colouring the shaders keep their own escape radii, which the counts were always taken at
+        shader.setUniform("u_palette", paletteTexture);
+        shader.setUniform("u_paletteEntries", (float) paletteSize);
+        shader.setUniform("u_paletteScale", GetPaletteScale(request));
+        shader.setUniform("u_smooth", smooth);
+        shader.setUniform("u_bailout", smooth ? (float) smoothBailout : julia ? 4.0f : 2.0f);
+    };
+
+    // Draws the columns x rows block at (column, row) of the view at 1 / scale of the window resolution into target
+    auto drawBand = [&](sf::RenderTarget &target, bool deep, int scale, int passWidth, int passHeight, int column, int row, int columns, int rows) {
+        double passResolution = resolution / scale;
+
+        if (deep) {
+            RenderRequest deepRequest = deepViewRequest(scale, passWidth, passHeight);
+
+            // Bands of the full resolution pass are regions of one continuation frame, coarser passes don't keep any state
+            int frameX, frameY;
+            if (scale == 1 && !deepContinuation.Locate(deepRequest, frameX, frameY)) {
+                deepContinuation.Reset(deepRequest);
+            }
+
+            // Image rows run up the imaginary axis while canvas rows run down the screen
+            RenderRequest band = RegionRequest(deepRequest, column, passHeight - row - rows, columns, rows);
+
+            if (deepBackend.Render(band, deepImage) && deepTexture.loadFromImage(deepImage)) {
+                sf::Sprite sprite = sf::Sprite(deepTexture);
+
+                sprite.setScale(sf::Vector2f(1, -1));
+                sprite.setPosition(sf::Vector2f(column, row + rows));
+
+                target.draw(sprite);
+            }
+
+            return;
+        }
+
+        surface.setSize(sf::Vector2f(columns, rows));
+        surface.setPosition(sf::Vector2f(column, row));
+
+        if (resolution > floatPrecisionResolution) {
+            sf::Shader *shader = julia ? &juliaDoubleFloatShader : &mandelbrotDoubleFloatShader;
+
+            float pixelSize[2];
+            float pivotDf[4];
+            SplitDouble(1.0 / passResolution, pixelSize[0], pixelSize[1]);
+            SplitDouble(pivotReal.ToDouble(), pivotDf[0], pivotDf[1]);
+            SplitDouble(pivotImag.ToDouble(), pivotDf[2], pivotDf[3]);
+
+            shader->setUniform("u_dimensions", sf::Glsl::Vec2(passWidth, passHeight));
+            shader->setUniform("u_pixelSize", sf::Glsl::Vec2(pixelSize[0], pixelSize[1]));
+            shader->setUniform("u_iterations", iterations);
+            shader->setUniform("u_pivot", sf::Glsl::Vec4(pivotDf[0], pivotDf[1], pivotDf[2], pivotDf[3]));
+            shader->setUniform("u_origin", origin);
+            shader->setUniform("u_split", 4097.0f);
+            setShading(*shader);
+
+            target.draw(surface, shader);
+        } else {
+            p_shader->setUniform("u_dimensions", sf::Glsl::Vec2(passWidth, passHeight));
+            p_shader->setUniform("u_resolution", (float) passResolution);
+            p_shader->setUniform("u_iterations", iterations);
+            p_shader->setUniform("u_pivot", sf::Vector2f(pivotReal.ToDouble(), pivotImag.ToDouble()));
+            p_shader->setUniform("u_origin", origin);
+            setShading(*p_shader);
+
+            target.draw(surface, p_shader);
+        }
+    };
     sf::RenderWindow window = sf::RenderWindow(sf::VideoMode(sf::Vector2u(width, height)), "Mandelbrot Set Viewer");
 
     while (window.isOpen()) {
@@ -106,13 +411,17 @@ int main(int argc, char **argv) {
 
             if (const auto *mouseMoved = event->getIf<sf::Event::MouseMoved>()) {
                 if (dragged) {
-                    pivot += sf::Vector2f(lastMousePos.x - mouseMoved->position.x, mouseMoved->position.y - lastMousePos.y) / resolution;
+                    pivotReal += BigFloat::FromDouble((lastMousePos.x - mouseMoved->position.x) / resolution, pivotReal.GetFractionLimbs());
+                    pivotImag += BigFloat::FromDouble((mouseMoved->position.y - lastMousePos.y) / resolution, pivotImag.GetFractionLimbs());
+                    panX += mouseMoved->position.x - lastMousePos.x;
+                    panY += mouseMoved->position.y - lastMousePos.y;
                     rerender = true;
                 } else if (!locked){
-                    origin += sf::Vector2f(lastMousePos.x - mouseMoved->position.x, mouseMoved->position.y - lastMousePos.y) / resolution;
+                    origin += sf::Vector2f(lastMousePos.x - mouseMoved->position.x, mouseMoved->position.y - lastMousePos.y) / (float) resolution;
 
                     if (julia) {
                         rerender = true;
+                        recompute = true;
                     }
                 }
 
@@ -120,28 +429,34 @@ int main(int argc, char **argv) {
             }
 
             if (const auto *scrolled = event->getIf<sf::Event::MouseWheelScrolled>()) {
-                float oldResolution = resolution;
-                resolution *= std::powf(2, scrolled->delta);
+                double oldResolution = resolution;
+                resolution *= std::pow(2.0, scrolled->delta);
 
-                if (resolution < 1.0f) {
-                    resolution = 1.0f;
+                if (resolution < 1.0) {
+                    resolution = 1.0;
                 }
-                
+
+                int limbs = BigFloat::LimbsForResolution(resolution * std::max(width, height));
+                pivotReal.SetFractionLimbs(limbs);
+                pivotImag.SetFractionLimbs(limbs);
 
                 if (!locked) {
-                    origin = pivot + (origin - pivot) * resolution / oldResolution;
+                    sf::Vector2f pivot = sf::Vector2f(pivotReal.ToDouble(), pivotImag.ToDouble());
+                    origin = pivot + (origin - pivot) * (float) (resolution / oldResolution);
                 }
 
                 rerender = true;
+                recompute = true;
             }
 
             if (const auto *resized = event->getIf<sf::Event::Resized>()) {
                 width = resized->size.x;
                 height = resized->size.y;
 
-                origin = sf::Vector2f(width / 2 - lastMousePos.x, lastMousePos.y - height / 2) / resolution;
+                origin = sf::Vector2f(width / 2 - lastMousePos.x, lastMousePos.y - height / 2) / (float) resolution;
 
                 rerender = true;
+                recompute = true;
             }
 
             if (const auto *keyPressed = event->getIf<sf::Event::KeyPressed>()) {
@@ -151,6 +466,7 @@ int main(int argc, char **argv) {
                         iterations += 100;
 
                         rerender = true;
+                        recompute = true;
                     break;
 
                     // Decrease iteration count
@@ -162,6 +478,7 @@ int main(int argc, char **argv) {
                         }
 
                         rerender = true;
+                        recompute = true;
                     break;
 
                     // Change modes
@@ -175,6 +492,44 @@ int main(int argc, char **argv) {
                         }
 
                         rerender = true;
+                        recompute = true;
+                    break;
+
+                    // Toggle tiled mode
+                    case sf::Keyboard::Key::T:
+                        tiled = !tiled;
+
+                        rerender = true;
+                        recompute = true;
+                    break;
+
+                    // Next palette
+                    case sf::Keyboard::Key::P:
+                        palette = (PaletteType) (((int) palette + 1) % 4);
+                        paletteTexture.update(reinterpret_cast<const std::uint8_t *>(GetPaletteTable(palette)));
+
+                        rerender = true;
+                        recompute = true;
+                    break;
+
+                    // Toggle smooth colouring
+                    case sf::Keyboard::Key::S:
+                        smooth = !smooth;
+
+                        rerender = true;
+                        recompute = true;
+                    break;
+
+                    // Next palette cycle length, 0 stretches the palette over the iteration limit
+                    case sf::Keyboard::Key::C:
+                        paletteCycle = paletteCycle == 0 ? 16 : paletteCycle * 4;
+
+                        if (paletteCycle > 1024) {
+                            paletteCycle = 0;
+                        }
+
+                        rerender = true;
+                        recompute = true;
                     break;
 
                     // Lock value of C
@@ -182,29 +537,179 @@ int main(int argc, char **argv) {
                         locked = !locked;
 
                         if (!locked) {
-                            origin = sf::Vector2f(width / 2 - lastMousePos.x, lastMousePos.y - height / 2) / resolution;
+                            origin = sf::Vector2f(width / 2 - lastMousePos.x, lastMousePos.y - height / 2) / (float) resolution;
                             rerender = true;
+                            recompute = true;
                         }
                     break;
                 }
             }
         }
 
+        // Float shaders first, then the double-float ones, and past those the perturbation engine
+        bool deep = !julia && resolution > doubleFloatPrecisionResolution;
+
+        // Tiles replace the progressive passes, every frame renders missing tiles for the budget and shows the rest
+        // from their cached ancestors. Zooms that leave the power of two levels fall back to the passes
+        RenderRequest tiledView = deepViewRequest(1, width, height);
+        int tileLevel;
+
+        if (tiled && !julia && TiledBackend::GetTileLevel(tiledView, tileLevel) && (rerender || !tileMissing.empty())) {
+            TiledBackend &tiler = deep ? deepTiler : shallowTiler;
+
+            if (rerender) tiler.Assemble(tiledView, tileImage, tileMissing);
+
+            if (tiler.RenderMissing(tiledView, tileMissing, frameBudgetMs)) tiler.Assemble(tiledView, tileImage, tileMissing);
+            else tileMissing.clear();
+
+            if (tileTexture.loadFromImage(tileImage)) {
+                sf::Sprite sprite = sf::Sprite(tileTexture);
+
+                sprite.setScale(sf::Vector2f(1, -1));
+                sprite.setPosition(sf::Vector2f(0, height));
+
+                window.clear();
+                window.draw(sprite);
+                window.display();
+            }
+
+            // Nothing of the passes is on screen anymore
+            passScale = 0;
+            shownScale = 0;
+            rerender = false;
+            recompute = false;
+            panX = 0;
+            panY = 0;
+        }
+
+        // Any change to the view drops the pass in progress
         if (rerender) {
-            p_shader->setUniform("u_dimensions", sf::Glsl::Vec2(width, height));
-            p_shader->setUniform("u_resolution", resolution);
-            p_shader->setUniform("u_iterations", iterations);
-            p_shader->setUniform("u_pivot", pivot);
-            p_shader->setUniform("u_origin", origin);
-            
-            surface.setSize(sf::Vector2f(width, height));
-            surface.setPosition(sf::Vector2f(0, 0));
+            double &cost = deep ? deepCost : shaderCost;
+
+            // A pan of a finished view shifts it over and only draws the strips that scrolled in, when they fit the budget
+            int exposed = std::abs(panX) * height + std::abs(panY) * width;
+            bool panned = !recompute && shownScale == 1 && passScale == 0 && std::abs(panX) < width && std::abs(panY) < height && cost * exposed <= frameBudgetMs;
+
+            // When only the limit of a finished deep view changed, the full resolution pass just continues its pixels
+            const RenderRequest &frame = deepContinuation.GetFrame();
+            bool continued = deep && shownScale == 1 && frame.width == width && frame.height == height && frame.resolution == resolution &&
+                             frame.deepPivotReal == pivotReal.ToString() && frame.deepPivotImag == pivotImag.ToString();
+
+            passScale = 1;
+
+            if (panned) {
+                sf::RenderTexture &canvas = canvases[1 - shown];
+
+                if (canvas.getSize() != sf::Vector2u(width, height) && !canvas.resize(sf::Vector2u(width, height))) {
+                    std::cout << "An error occured when trying to resize the refinement canvas!\n";
+                    return -1;
+                }
+
+                auto start = std::chrono::steady_clock::now();
+
+                canvas.clear();
+
+                sf::Sprite previous = sf::Sprite(canvases[shown].getTexture());
+                previous.setPosition(sf::Vector2f(panX, panY));
+                canvas.draw(previous);
+
+                // The state of the pixels that are still in view moves along, so the limit can still be raised cheaply
+                if (deep) {
+                    deepContinuation.Reframe(deepViewRequest(1, width, height));
+                }
+
+                // Columns that scrolled in, then rows that scrolled in across the rest of the width
+                if (panX != 0) {
+                    drawBand(canvas, deep, 1, width, height, panX > 0 ? 0 : width + panX, 0, std::abs(panX), height);
+                }
+
+                if (panY != 0) {
+                    drawBand(canvas, deep, 1, width, height, std::max(panX, 0), panY > 0 ? 0 : height + panY, width - std::abs(panX), std::abs(panY));
+                }
+
+                canvas.display();
+                shown = 1 - shown;
+
+                window.clear();
+                window.draw(sf::Sprite(canvas.getTexture()));
+                window.display();
+
+                if (exposed > 0) {
+                    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    double sample = elapsed / exposed;
+                    cost = cost == 0 ? sample : 0.75 * cost + 0.25 * sample;
+                }
+
+                passScale = 0;
+            } else if (!continued && cost == 0) {
+                passScale = coarsestScale;
+            } else if (!continued) {
+                while (passScale < coarsestScale && cost * ((double) width / passScale) * ((double) height / passScale) > frameBudgetMs) {
+                    passScale *= 2;
+                }
+            }
+
+            passRow = 0;
+            rerender = false;
+            recompute = false;
+            panX = 0;
+            panY = 0;
+        }
+
+        if (passScale > 0) {
+            sf::RenderTexture &canvas = canvases[1 - shown];
+            int passWidth = (width + passScale - 1) / passScale;
+            int passHeight = (height + passScale - 1) / passScale;
+
+            if (passRow == 0) {
+                if (canvas.getSize() != sf::Vector2u(passWidth, passHeight) && !canvas.resize(sf::Vector2u(passWidth, passHeight))) {
+                    std::cout << "An error occured when trying to resize the refinement canvas!\n";
+                    return -1;
+                }
+
+                canvas.clear();
+            }
+
+            // As many rows as the measured cost lets through in one frame, at least one
+            double &cost = deep ? deepCost : shaderCost;
+            int rows = passHeight - passRow;
+
+            if (cost > 0) {
+                rows = std::clamp((int) (frameBudgetMs / (cost * passWidth)), 1, rows);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            drawBand(canvas, deep, passScale, passWidth, passHeight, 0, passRow, passWidth, rows);
+            canvas.display();
+
+            passRow += rows;
 
             window.clear();
-            window.draw(surface, p_shader);
+
+            // Last complete pass underneath, the finished rows of the finer one on top
+            if (shownScale > 0) {
+                sf::Sprite previous = sf::Sprite(canvases[shown].getTexture());
+                previous.setScale(sf::Vector2f(shownScale, shownScale));
+                window.draw(previous);
+            }
+
+            sf::Sprite current = sf::Sprite(canvas.getTexture(), sf::IntRect(sf::Vector2i(0, 0), sf::Vector2i(passWidth, passRow)));
+            current.setScale(sf::Vector2f(passScale, passScale));
+            window.draw(current);
+
             window.display();
 
-            rerender = false;
+            double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            double sample = elapsed / ((double) passWidth * rows);
+            cost = cost == 0 ? sample : 0.75 * cost + 0.25 * sample;
+
+            if (passRow >= passHeight) {
+                shown = 1 - shown;
+                shownScale = passScale;
+                passScale /= 2;
+                passRow = 0;
+            }
         }
     }
 
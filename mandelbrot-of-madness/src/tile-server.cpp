@@ -0,0 +1,79 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include "core/command-line.hpp"
+#include "core/tile-server.hpp"
+#include "core/multithreaded-backend.hpp"
+#include "core/gpu-backend.hpp"
+#include "core/perturbation-backend.hpp"
+
+static bool ParseNumber(const char *text, long long &value) {
+    std::istringstream stream(text);
+    return (stream >> value) && stream.eof() && value > 0;
+}
+
+int main(int argc, char **argv) {
+    TileServerOptions options;
+    std::string backendName = "multithreaded";
+
+    // Server flags are taken out here, the backend flags go to the shared parser
+    std::vector<char *> args = {argv[0]};
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        long long value = 0;
+        bool valid = true;
+
+        if (arg == "--port" && i + 1 < argc) {
+            valid = ParseNumber(argv[++i], value) && value < 65536;
+            options.port = (unsigned short) value;
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backendName = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            valid = ParseNumber(argv[++i], value) && value <= options.maxIterations;
+            options.defaultIterations = (int) value;
+        } else if (arg == "--queue" && i + 1 < argc) {
+            valid = ParseNumber(argv[++i], value);
+            options.queueCapacity = (size_t) value;
+        } else {
+            args.push_back(argv[i]);
+        }
+
+        if (!valid) {
+            std::cerr << "An error occured when trying to parse the value of " << arg << "!\n";
+            return -1;
+        }
+
+        if (arg == "--help" || arg == "-h") {
+            std::cerr << "Tile server: --port N (8080), --backend multithreaded|gpu, --iterations N for tiles that don't\n";
+            std::cerr << "ask with ?iterations=N, --queue N tiles waiting to render. Serves /z/x/y.png and a viewer at /\n\n";
+        }
+    }
+
+    CommandLine commandLine;
+    if (!ParseCommandLine(args.size(), args.data(), commandLine)) return -1;
+
+    if (!commandLine.jobs.empty()) {
+        std::cerr << "An error occured when trying to start the tile server, it takes no frame flags!\n";
+        return -1;
+    }
+
+    options.spillDirectory = commandLine.tileCachePath;
+
+    std::unique_ptr<RenderBackend> backend;
+
+    if (backendName == "multithreaded") backend.reset(new MultiThreadedBackend(commandLine.threading));
+    else if (backendName == "gpu") backend.reset(new GpuBackend(commandLine.gpu));
+    else {
+        std::cerr << "An error occured when trying to pick backend " << backendName << "!\n";
+        return -1;
+    }
+
+    // Levels past double-float precision always go to the perturbation engine
+    PerturbationBackend deepBackend(commandLine.threading);
+
+    TileServer server(*backend, deepBackend, options);
+
+    return server.Run() ? 0 : -1;
+}